@@ -8,6 +8,8 @@
 #include <map>
 #include <cstddef>
 #include <cstdlib>
+#include <cstring>
+#include <algorithm>
 using namespace std;
 
 // OpenGL related headers
@@ -15,6 +17,12 @@ using namespace std;
 #include <GLFW/glfw3.h>
 #include <AntTweakBar.h>
 #include "ShaderProgram.h"
+#include "ParticleSystem.h"
+#include "TruckSim.h"
+#include "DynamicResolution.h"
+#include "Camera.h"
+#include "StatsOverlay.h"
+#include "WorkerPool.h"
 #include <glm/fwd.hpp>
 #include <glm/gtx/transform.hpp> 
 using namespace glm;
@@ -25,12 +33,45 @@ struct VertexColor {
 			color[3];	// color - r,g,b
 };
 
+// opaque draw call - a range of gVBO drawn with one object's model matrix
+struct DrawItem {
+	string model;		// key into gModelMatrix
+	GLenum mode;		// primitive type
+	GLint first;		// first vertex
+	GLsizei count;		// number of vertices
+	float depth;		// layer along z, larger = nearer the camera (replaces draw order)
+	vec2 boundsCenter = vec2(0.0f);		// bounding circle in model space, for culling
+	float boundsRadius = 0.0f;
+};
+
+// per draw item data - std140 layout of Instance in colorTransform.vert
+struct InstanceData {
+	mat4 modelMatrix;
+	vec4 depth;			// x = layer along z
+};
+
+// one viewport of the window and the camera drawn into it
+struct View {
+	ivec4 viewport;		// x, y, width, height in pixels of the render target (origin bottom left)
+	Camera camera;
+	vector<int> visible;	// draw items passing culling this frame, front-to-back
+	bool particles;			// particles may be visible this frame
+	float pointScale;		// particle size for the view's resolution and zoom
+};
+
 // global variables
 // settings
 unsigned int gWindowWidth = 800, gWindowHeight = 800;
 
 // scene content
 ShaderProgram gShader;	// shader program object
+ShaderProgram gOverdrawShader;	// counts shaded fragments per pixel
+vector<DrawItem> gDrawItems;	// opaque draw calls, sorted front-to-back
+const int gMaxInstances = 16;	// draw items that fit in the instance buffer (must match colorTransform.vert)
+const GLuint gInstanceBinding = 1;	// uniform buffer binding point of InstanceBlock
+GLuint gInstanceUBO = 0,	// per draw item data, uploaded once per frame and shared by all views
+	   gCameraUBO = 0;		// camera data of every view, one aligned slot per view
+GLint gCameraStride = 0;	// bytes between views in gCameraUBO
 GLuint gVBO = 0,		// vertex buffer object identifier
 	   gVAO = 0;		// vertex array object identifier
 
@@ -50,15 +91,54 @@ vec3 gBackWheelCenter(0.225f, -0.375f, 0.0f);
 float gFrameRate = 60.0f, 
 	  gFrameTime = 1 / gFrameRate;
 
+// stats overlay - frame time text, graph and histogram (F2 or --no-overlay to switch off)
+StatsOverlay gOverlay;
+bool gShowOverlay = true;
+const float gOverlayRefresh = 0.1f;	// seconds between updates of the displayed values
+
+// tweak bar (F1 or --no-ui to switch off, which also skips its drawing cost)
+bool gShowUI = true;
+
 // controls - wireframe and background color
 bool gWireframe = false;	// switch between wireframe and fill
 vec3 gBGColor(0.2f);
+
+// dynamic resolution - scene rendered offscreen at a scale that holds the target time
+DynamicResolution gResolution;
+bool gDynamicResolution = true;		// switch between scaled offscreen and direct rendering
+float gTargetSceneTime = 12.0f,		// target GPU time of the scene pass (ms)
+	  gMinScale = 0.25f,			// render scale limits
+	  gMaxScale = 1.0f,
+	  gRenderScale = 1.0f,			// current render scale (UI display)
+	  gSceneTime = 0.0f;			// measured GPU time of the scene pass (ms, UI display)
 	
 // transformation sensitives
 const float gTranslateSensitivity = 0.1f,
 			gRotateSensitivity = 0.1f,
 			gWheelRotateSensitivity = 1.0f,
 			gScaleSensitivity = 0.1f;
+// sensitivities passed to the truck simulation
+TruckSimParams gTruckParams = { gTranslateSensitivity, gRotateSensitivity, gWheelRotateSensitivity };
+
+// camera - follows the truck, panned with W/A/S/D and zoomed with the mouse wheel
+Camera gCamera;
+bool gFollowTruck = true;		// keep the truck in view
+float gZoom = 1.0f,				// 1 = whole scene as without a camera
+	  gPanX = 0.0f, gPanY = 0.0f;	// offset from the followed point
+const float gPanSensitivity = 1.0f,
+			gFollowRate = 5.0f;
+
+// multiple viewports - a grid of views sharing the scene's buffers, culled on worker threads
+const int gMaxViewGrid = 3;		// up to 3 x 3 views
+int gViewGrid = 1;				// views per row and column
+unsigned int gDrawCalls = 0,		// opaque draw calls issued last frame (UI display)
+			 gParticleVertices = 0;	// particle vertices drawn last frame over all views
+vector<View> gViews;
+WorkerPool gWorkers;
+
+// opaque pass debugging
+bool gFrontToBack = true,	// draw opaque layers nearest first so covered pixels fail the depth test
+	 gShowOverdraw = false;	// show how many fragments were shaded per pixel
 
 // transformation control via UI
 float gGroundSlope = 0,	// slope of the ground
@@ -69,6 +149,21 @@ float gGroundSlope = 0,	// slope of the ground
 // obj model matric
 map<string, mat4> gModelMatrix;		// store transformation matrices for the different obj
 
+// particles - exhaust and dust simulated on the GPU
+ParticleSystem gParticles;
+const unsigned int gMaxParticles = 262144;	// particles in each simulation buffer
+const float gExhaustIdleRate = 2000.0f,		// exhaust particles per second when standing still
+			gExhaustThrottleRate = 20000.0f,// extra exhaust at full speed
+			gExhaustClimbRate = 30000.0f,	// extra exhaust when driving up the slope
+			gDustRate = 40000.0f,			// dust particles per second per wheel at full speed
+			gExhaustLife = 3.0f,			// maximum particle lifetimes in seconds
+			gDustLife = 1.5f;
+// exhaust pipe at the back of the truck, in truck model space
+const vec3 gExhaustPosition(0.38f, -0.33f, 0.0f);
+bool gParticlesEnabled = true;	// switch particle simulation and rendering on/off
+float gEmissionScale = 1.0f,	// scales all emission rates
+	  gTruckSpeed = 0.0f;		// truck velocity along the ground (x-axis) per second
+
 
 // generate vertices for circles - tires and wheels
 	// no scale factor provided for circle to maintain circular wheels no matter window size
@@ -127,6 +222,15 @@ static void init(GLFWwindow* window) {
 
 	// compile and link a vertex and fragment shader pair
 	gShader.compileAndLink("colorTransform.vert", "color.frag");
+	gOverdrawShader.compileAndLink("colorTransform.vert", "overdraw.frag");
+	gShader.setUniformBlock("CameraBlock", CAMERA_BLOCK_BINDING);
+	gShader.setUniformBlock("InstanceBlock", gInstanceBinding);
+	gOverdrawShader.setUniformBlock("CameraBlock", CAMERA_BLOCK_BINDING);
+	gOverdrawShader.setUniformBlock("InstanceBlock", gInstanceBinding);
+
+	// opaque objects overlap, so each part gets its own layer - ordered as they used to be painted
+	glEnable(GL_DEPTH_TEST);
+	glDepthFunc(GL_LESS);
 
 	// initialize model matrices to identity matrices
 	gModelMatrix["Ground"] = mat4(1.0f);
@@ -261,6 +365,69 @@ static void init(GLFWwindow* window) {
 
 	glEnableVertexAttribArray(0);	// enable vertex attributes
 	glEnableVertexAttribArray(1);
+
+	// opaque draw calls
+	gDrawItems = {
+		{ "Ground", GL_TRIANGLE_STRIP, 0, 4, 0.0f },			// ground
+		{ "Truck", GL_TRIANGLE_STRIP, 4, 6, 0.10f },			// driver compartment
+		{ "Truck", GL_TRIANGLE_STRIP, 10, 4, 0.11f },			// window
+		{ "Truck", GL_TRIANGLE_STRIP, 14, 6, 0.12f },			// truck back
+		{ "Truck", GL_TRIANGLE_STRIP, 20, 4, 0.13f },			// base
+		{ "FrontWheel", GL_TRIANGLE_FAN, 24, gSlices + 2, 0.20f },						// front tire
+		{ "FrontWheel", GL_TRIANGLE_FAN, 24 + gSlices + 2, gSlices + 2, 0.21f },		// front wheel
+		{ "BackWheel", GL_TRIANGLE_FAN, 24 + (2 * (gSlices + 2)), gSlices + 2, 0.22f },	// back tire
+		{ "BackWheel", GL_TRIANGLE_FAN, 24 + (3 * (gSlices + 2)), gSlices + 2, 0.23f },	// back wheel
+	};
+	// front-to-back so the ground behind the truck is rejected by the depth test
+	stable_sort(gDrawItems.begin(), gDrawItems.end(),
+		[](const DrawItem& a, const DrawItem& b) { return a.depth > b.depth; });
+
+	// every draw item needs a slot in the instance buffer
+	if (gDrawItems.size() > gMaxInstances)
+	{
+		cerr << "Too many draw items for the instance buffer: " << gDrawItems.size()
+			 << " (max " << gMaxInstances << ")" << endl;
+		exit(EXIT_FAILURE);
+	}
+
+	// bounding circle of each item's vertices for per-view culling
+	const size_t stride = sizeof(VertexColor) / sizeof(GLfloat);
+	for (DrawItem& item : gDrawItems) {
+		vec2 lower(vertices[item.first * stride], vertices[item.first * stride + 1]), upper = lower;
+		for (GLint v = item.first; v < item.first + item.count; v++) {
+			lower = glm::min(lower, vec2(vertices[v * stride], vertices[v * stride + 1]));
+			upper = glm::max(upper, vec2(vertices[v * stride], vertices[v * stride + 1]));
+		}
+		item.boundsCenter = (lower + upper) * 0.5f;
+		item.boundsRadius = length(upper - lower) * 0.5f;
+	}
+
+	// instance buffer - per draw item data shared by every view
+	glGenBuffers(1, &gInstanceUBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, gInstanceUBO);
+	glBufferData(GL_UNIFORM_BUFFER, sizeof(InstanceData) * gMaxInstances, nullptr, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_UNIFORM_BUFFER, gInstanceBinding, gInstanceUBO);
+
+	// camera buffer - one slot per view, each slot aligned so it can be bound as a range
+	GLint alignment = 0;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	gCameraStride = ((static_cast<GLint>(sizeof(CameraData)) + alignment - 1) / alignment) * alignment;
+	glGenBuffers(1, &gCameraUBO);
+	glBindBuffer(GL_UNIFORM_BUFFER, gCameraUBO);
+	glBufferData(GL_UNIFORM_BUFFER, gCameraStride * gMaxViewGrid * gMaxViewGrid, nullptr, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	// threads for per-view culling
+	gWorkers.start();
+
+	// create particle buffers and shaders
+	gParticles.init(gMaxParticles);
+
+	// create the offscreen framebuffer the scene is rendered into
+	gResolution.init(gWindowWidth, gWindowHeight);
+
+	// create the stats overlay's font atlas and buffers
+	gOverlay.init(gWindowWidth, gWindowHeight);
 }
 
 // update scene
@@ -272,39 +439,32 @@ static void update_scene(GLFWwindow* window) {
 	vec3 moveTruckVec(0.0f);
 	float rotateAngle = 0.0f;
 
-	// update variables based on keyboard input ============
-	// left, right arrows - move truck, rotate wheels
-	if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS) {
-		moveTruckVec.x -= gTranslateSensitivity * gFrameTime;
-		gTruckPos += moveTruckVec.x;
-		gRotateWheelAngle += gWheelRotateSensitivity * gFrameTime;
-	}
-	if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS) {
-		moveTruckVec.x += gTranslateSensitivity * gFrameTime;
-		gTruckPos += moveTruckVec.x;
-		gRotateWheelAngle -= gWheelRotateSensitivity * gFrameTime;
-	}
-	// up, down arrows - tilt ground slope
-	if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS) {
-		if (gGroundSlope < 15.0f) {
-			rotateAngle -= gRotateSensitivity * gFrameTime;
-			gGroundSlope -= degrees(rotateAngle);
-			gPrevSlope = gGroundSlope;
-		}
-	}
-	if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS) {
-		if (gGroundSlope > -15.0f) {
-			rotateAngle += gRotateSensitivity * gFrameTime;
-			gGroundSlope -= degrees(gRotateSensitivity * gFrameTime);
-			gPrevSlope = gGroundSlope;
-		}
-	}
 	// check if slope changed from UI interaction
 	if (gGroundSlope != gPrevSlope) {
 		rotateAngle += radians(gPrevSlope - gGroundSlope);
 		// note: if we just take gGroundSlope, the obj will keep spinning
 	}
 
+	// update variables based on keyboard input ============
+	// left, right arrows - move truck, rotate wheels
+	// up, down arrows - tilt ground slope
+	float drive = 0.0f, tilt = 0.0f;
+	if (glfwGetKey(window, GLFW_KEY_LEFT) == GLFW_PRESS)
+		drive -= 1.0f;
+	if (glfwGetKey(window, GLFW_KEY_RIGHT) == GLFW_PRESS)
+		drive += 1.0f;
+	if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
+		tilt += 1.0f;
+	if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
+		tilt -= 1.0f;
+
+	// advance the truck simulation, then turn its change into transformations
+	float prevPos = gTruckPos,
+		  prevSlope = gGroundSlope;
+	truck_sim_step(gTruckPos, gGroundSlope, gRotateWheelAngle, gTruckParams, drive, tilt, gFrameTime);
+	moveTruckVec.x = gTruckPos - prevPos;
+	rotateAngle += radians(prevSlope - gGroundSlope);
+
 	// update model matrices
 	gModelMatrix["Ground"] *= translate(vec3(1.0f, -0.5f, 0.0f))
 		* rotate(rotateAngle, vec3(0.0f, 0.0f, 1.0f))
@@ -322,6 +482,163 @@ static void update_scene(GLFWwindow* window) {
 
 	// update gPrevSlope
 	gPrevSlope = gGroundSlope;
+
+	// truck speed drives particle emission
+	gTruckSpeed = moveTruckVec.x / gFrameTime;
+}
+
+// set emitters from the truck's transform and advance the particles
+static void update_particles() {
+	if (!gParticlesEnabled)
+		return;
+
+	mat4 truck = gModelMatrix["Truck"];
+
+	// throttle in [-1, 1] (negative = driving left), climbing when driving towards the raised side
+	float throttle = glm::clamp(gTruckSpeed / gTranslateSensitivity, -1.0f, 1.0f),
+		  climb = glm::max(-throttle * gGroundSlope / 15.0f, 0.0f),
+		  roughness = 1.0f + abs(gGroundSlope) / 15.0f;
+
+	ParticleEmitter emitters[3];
+
+	// exhaust - backwards and up from the pipe
+	emitters[0].position = vec3(truck * vec4(gExhaustPosition, 1.0f));
+	emitters[0].direction = vec3(truck * vec4(0.15f, 0.1f, 0.0f, 0.0f));
+	emitters[0].spread = 0.04f;
+	emitters[0].rate = gEmissionScale * (gExhaustIdleRate
+		+ abs(throttle) * gExhaustThrottleRate + climb * gExhaustClimbRate);
+	emitters[0].life = gExhaustLife;
+	emitters[0].type = PARTICLE_EXHAUST;
+
+	// dust - kicked up behind the wheels where the tires touch the ground
+	vec3 wheelCenters[2] = { gFrontWheelCenter, gBackWheelCenter };
+	for (int i = 0; i < 2; i++) {
+		ParticleEmitter& dust = emitters[1 + i];
+		dust.position = vec3(truck * vec4(wheelCenters[i] - vec3(0.0f, gTireRadius, 0.0f), 1.0f));
+		dust.direction = vec3(truck * vec4(-throttle * 0.2f, 0.25f, 0.0f, 0.0f));
+		dust.spread = 0.1f;
+		dust.rate = gEmissionScale * abs(throttle) * roughness * gDustRate;
+		dust.life = gDustLife;
+		dust.type = PARTICLE_DUST;
+	}
+
+	gParticles.update(emitters, 3, gFrameTime);
+}
+
+// move the main camera with the user's pan and zoom
+static void update_camera(GLFWwindow* window) {
+	// W/A/S/D pan, scaled so the view moves at the same speed on screen at any zoom
+	float pan = gPanSensitivity * gFrameTime / gZoom;
+	if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+		gPanY += pan;
+	if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+		gPanY -= pan;
+	if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+		gPanX -= pan;
+	if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+		gPanX += pan;
+
+	// follow the truck's model origin, so the initial view matches the scene without a camera
+	vec2 target(gPanX, gPanY);
+	if (gFollowTruck) {
+		vec4 truck = gModelMatrix["Truck"] * vec4(0.0f, 0.0f, 0.0f, 1.0f);
+		target += vec2(truck.x, truck.y);
+	}
+	gCamera.follow(target, gFollowRate, gFrameTime);
+	gCamera.mHalfHeight = 1.0f / gZoom;
+}
+
+// world position of a point given in an object's model space
+static vec2 world_point(const string& model, const vec3& point) {
+	vec4 world = gModelMatrix[model] * vec4(point, 1.0f);
+	return vec2(world.x, world.y);
+}
+
+// lay out the views, upload camera and instance data once, then cull each view on the workers
+static void update_views(int targetWidth, int targetHeight) {
+	int views = gViewGrid * gViewGrid;
+	gViews.resize(views);
+
+	// the first view is the user's camera, the others follow fixed points of interest
+	struct Shot { vec2 target; float halfHeight; };
+	Shot shots[gMaxViewGrid * gMaxViewGrid] = {
+		{ gCamera.mCenter, gCamera.mHalfHeight },									// main camera
+		{ vec2(0.0f, -0.75f), 2.5f },												// overview
+		{ world_point("Truck", vec3(0.0f, -0.25f, 0.0f)), 0.5f },					// close-up
+		{ world_point("Truck", gFrontWheelCenter), 0.2f },							// front wheel detail
+		{ world_point("Truck", gBackWheelCenter), 0.2f },							// back wheel detail
+		{ world_point("Truck", gExhaustPosition), 0.25f },							// exhaust
+		{ world_point("Truck", vec3(0.0f, -0.25f, 0.0f)), 1.5f },					// wide
+		{ world_point("Truck", vec3(-0.22f, -0.2f, 0.0f)), 0.2f },					// driver compartment
+		{ vec2(1.0f, -0.5f), 0.5f },												// slope pivot
+	};
+
+	// cameras - row-major grid starting at the top left, laid out at gCameraStride
+	vector<GLubyte> cameras(views * gCameraStride);
+	for (int v = 0; v < views; v++) {
+		View& view = gViews[v];
+
+		// pixel edges shared with the neighbouring views, so no column or row is left uncovered
+		int column = v % gViewGrid, row = gViewGrid - 1 - v / gViewGrid;
+		int x0 = column * targetWidth / gViewGrid, x1 = (column + 1) * targetWidth / gViewGrid,
+			y0 = row * targetHeight / gViewGrid, y1 = (row + 1) * targetHeight / gViewGrid;
+		view.viewport = ivec4(x0, y0, x1 - x0, y1 - y0);
+
+		if (v == 0)
+			view.camera = gCamera;
+		else
+			view.camera = Camera(shots[v].target, shots[v].halfHeight);
+		view.pointScale = gRenderScale * view.viewport.w / (targetHeight * view.camera.mHalfHeight);
+
+		CameraData camera;
+		camera.viewMatrix = view.camera.getViewMatrix();
+		camera.projectionMatrix = view.camera.getProjectionMatrix(static_cast<float>(view.viewport.z) / view.viewport.w);
+		memcpy(&cameras[v * gCameraStride], &camera, sizeof(CameraData));
+	}
+
+	// every view's camera in one upload
+	glBindBuffer(GL_UNIFORM_BUFFER, gCameraUBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, cameras.size(), cameras.data());
+
+	// instance data and world bounds of the draw items, shared by every view
+	size_t instanceCount = gDrawItems.size();
+	InstanceData instances[gMaxInstances];
+	vector<vec3> bounds(instanceCount);		// x, y = centre, z = radius
+	for (size_t i = 0; i < instanceCount; i++) {
+		const DrawItem& item = gDrawItems[i];
+		instances[i].modelMatrix = gModelMatrix[item.model];
+		instances[i].depth = vec4(item.depth, 0.0f, 0.0f, 0.0f);
+		// model matrices only rotate and translate, so the radius is unchanged
+		bounds[i] = vec3(world_point(item.model, vec3(item.boundsCenter, 0.0f)), item.boundsRadius);
+	}
+	glBindBuffer(GL_UNIFORM_BUFFER, gInstanceUBO);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(InstanceData) * instanceCount, instances);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+	// box every live particle is inside
+	vec4 particleBounds = gParticles.getBounds();
+
+	// culling touches no GL state, so views are culled in parallel
+	gWorkers.parallelFor(views, [&](int v) {
+		View& view = gViews[v];
+		vec4 visibleRect = view.camera.getBounds(static_cast<float>(view.viewport.z) / view.viewport.w);
+
+		view.visible.clear();
+		for (size_t i = 0; i < bounds.size(); i++) {
+			const vec3& circle = bounds[i];
+			if (circle.x + circle.z >= visibleRect.x && circle.x - circle.z <= visibleRect.z &&
+				circle.y + circle.z >= visibleRect.y && circle.y - circle.z <= visibleRect.w)
+				view.visible.push_back(static_cast<int>(i));
+		}
+
+		// all particles are one draw call - skip it when their box misses the view,
+		// widened by half the largest point in world units
+		float margin = 0.5f * PARTICLE_MAX_POINT_SIZE * view.pointScale
+			* 2.0f * view.camera.mHalfHeight / view.viewport.w;
+		view.particles = gParticlesEnabled &&
+			particleBounds.z + margin >= visibleRect.x && particleBounds.x - margin <= visibleRect.z &&
+			particleBounds.w + margin >= visibleRect.y && particleBounds.y - margin <= visibleRect.w;
+	});
 }
 
 // create and populate tweak bar elements
@@ -331,16 +648,36 @@ static TwBar* create_UI(const string name = "Interface") {
 	TwWindowSize(gWindowWidth, gWindowHeight);
 	TwDefine(" TW_HELP visible=false "); // disable help menu
 	TwDefine(" GLOBAL fontsize=3 ");	 //set large font size
-	TwDefine(" Main label='User Interface' refresh=0.02 text=light size='250 450' position='10 10' ");
-
-	// frame stat entries
-	TwAddVarRO(twBar, "Frame Rate", TW_TYPE_FLOAT,
-			   &gFrameRate, " group='Frame Stats' precision=2 ");
-	TwAddVarRO(twBar, "Frame Time", TW_TYPE_FLOAT,
-			   &gFrameTime, " group='Frame Stats' ");
+	// read-only values only need refreshing a couple of times a second,
+	// frame rate and frame time are shown by the stats overlay instead
+	TwDefine((" " + name + " label='User Interface' refresh=0.5 text=light size='250 450' position='10 10' ").c_str());
 
 	// display controls
 	TwAddVarRW(twBar, "Wireframe", TW_TYPE_BOOLCPP, &gWireframe, " group='Display' ");
+	TwAddVarRW(twBar, "Stats Overlay", TW_TYPE_BOOLCPP, &gShowOverlay, " group='Display' ");
+	TwAddVarRW(twBar, "Front-to-Back", TW_TYPE_BOOLCPP, &gFrontToBack, " group='Display' ");
+	TwAddVarRW(twBar, "Overdraw", TW_TYPE_BOOLCPP, &gShowOverdraw, " group='Display' ");
+
+	// camera controls
+	TwAddVarRW(twBar, "Follow Truck", TW_TYPE_BOOLCPP, &gFollowTruck, " group='Camera' ");
+	TwAddVarRW(twBar, "Zoom", TW_TYPE_FLOAT, &gZoom, " group='Camera' min=0.25 max=4.0 step=0.05");
+	TwAddVarRW(twBar, "Pan X", TW_TYPE_FLOAT, &gPanX, " group='Camera' step=0.01");
+	TwAddVarRW(twBar, "Pan Y", TW_TYPE_FLOAT, &gPanY, " group='Camera' step=0.01");
+
+	// viewports - 1, 4 or 9 views
+	TwAddVarRW(twBar, "Viewport Grid", TW_TYPE_INT32, &gViewGrid, " group='Viewports' min=1 max=3 ");
+	TwAddVarRO(twBar, "Draw Calls", TW_TYPE_UINT32, &gDrawCalls, " group='Viewports' ");
+
+	// dynamic resolution controls
+	TwAddVarRW(twBar, "Dynamic", TW_TYPE_BOOLCPP, &gDynamicResolution, " group='Resolution' ");
+	TwAddVarRW(twBar, "Target (ms)", TW_TYPE_FLOAT, &gTargetSceneTime,
+			   " group='Resolution' min=1.0 max=100.0 step=0.5");
+	TwAddVarRW(twBar, "Min Scale", TW_TYPE_FLOAT, &gMinScale,
+			   " group='Resolution' min=0.25 max=1.0 step=0.05");
+	TwAddVarRW(twBar, "Max Scale", TW_TYPE_FLOAT, &gMaxScale,
+			   " group='Resolution' min=0.25 max=1.0 step=0.05");
+	TwAddVarRO(twBar, "Scale", TW_TYPE_FLOAT, &gRenderScale, " group='Resolution' precision=2 ");
+	TwAddVarRO(twBar, "Scene (ms)", TW_TYPE_FLOAT, &gSceneTime, " group='Resolution' precision=2 ");
 
 	// background color control
 	TwAddVarRW(twBar, "Background", TW_TYPE_COLOR3F, &gBGColor,
@@ -354,51 +691,136 @@ static TwBar* create_UI(const string name = "Interface") {
 	TwAddVarRO(twBar, "Position", TW_TYPE_FLOAT, &gTruckPos,
 			   " group='Controls' min=-1.00 max=1.00 step=0.01");
 
+	// particle controls
+	TwAddVarRW(twBar, "Particles", TW_TYPE_BOOLCPP, &gParticlesEnabled, " group='Particles' ");
+	TwAddVarRW(twBar, "Emission", TW_TYPE_FLOAT, &gEmissionScale,
+			   " group='Particles' min=0.0 max=4.0 step=0.1");
+
 	return twBar;
 }
 
-// function to render the scene
-static void render_scene() {
-	// clear color buffer
-	glClear(GL_COLOR_BUFFER_BIT);
+// function to render the scene - every view from the same buffers
+static void render_scene(int targetWidth, int targetHeight) {
+	// overdraw view adds a constant per shaded fragment onto black
+	if (gShowOverdraw) {
+		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_ONE, GL_ONE);
+	}
 
-	gShader.use();						// use the shaders associated with the shader program
+	// clear color and depth buffers once for all views
+	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
+	ShaderProgram& shader = gShowOverdraw ? gOverdrawShader : gShader;
 	glBindVertexArray(gVAO);			// make VAO active
 
-	gShader.setUniform("uModelMatrix", gModelMatrix["Ground"]);	// set model matrix
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);	// draw ground
-
-	gShader.setUniform("uModelMatrix", gModelMatrix["Truck"]);	// set model matrix
-	glDrawArrays(GL_TRIANGLE_STRIP, 4, 6);	// draw driver compartment
-	glDrawArrays(GL_TRIANGLE_STRIP, 10, 4); // draw window
-	glDrawArrays(GL_TRIANGLE_STRIP, 14, 6);	// draw truck back
-	glDrawArrays(GL_TRIANGLE_STRIP, 20, 4); // draw base
+	// views only differ in viewport, scissor and which camera slot is bound
+	glEnable(GL_SCISSOR_TEST);
+	gDrawCalls = 0;
+	gParticleVertices = 0;
+	for (size_t v = 0; v < gViews.size(); v++) {
+		const View& view = gViews[v];
+		glViewport(view.viewport.x, view.viewport.y, view.viewport.z, view.viewport.w);
+		glScissor(view.viewport.x, view.viewport.y, view.viewport.z, view.viewport.w);
+		glBindBufferRange(GL_UNIFORM_BUFFER, CAMERA_BLOCK_BINDING, gCameraUBO,
+						  v * gCameraStride, sizeof(CameraData));
+
+		shader.use();					// use the shaders associated with the shader program
+
+		// opaque pass - nearest first, or farthest first to compare against painting
+		for (size_t i = 0; i < view.visible.size(); i++) {
+			int instance = view.visible[gFrontToBack ? i : view.visible.size() - 1 - i];
+			const DrawItem& item = gDrawItems[instance];
+			shader.setUniform("uInstance", instance);	// select model matrix and layer
+			glDrawArrays(item.mode, item.first, item.count);
+			gDrawCalls++;
+		}
 
-	gShader.setUniform("uModelMatrix", gModelMatrix["FrontWheel"]);	// set model matrix
-	glDrawArrays(GL_TRIANGLE_FAN, 24, gSlices + 2);					// draw front tire
-	glDrawArrays(GL_TRIANGLE_FAN, 24 + gSlices + 2, gSlices + 2);	// draw front wheel
+		// draw exhaust and dust over the scene, unless culled for this view
+		if (!gShowOverdraw && view.particles) {
+			gParticles.render(view.pointScale);
+			gParticleVertices += gParticles.getLiveCount();
+		}
+	}
+	glDisable(GL_SCISSOR_TEST);
+	glViewport(0, 0, targetWidth, targetHeight);
 
-	gShader.setUniform("uModelMatrix", gModelMatrix["BackWheel"]);	// set model matrix
-	glDrawArrays(GL_TRIANGLE_FAN, 24 + (2 * (gSlices + 2)), gSlices + 2); // draw back tire
-	glDrawArrays(GL_TRIANGLE_FAN, 24 + (3 * (gSlices + 2)), gSlices + 2); // draw back wheel
+	if (gShowOverdraw) {
+		glDisable(GL_BLEND);
+		glClearColor(gBGColor.r, gBGColor.g, gBGColor.b, 1.0f);
+	}
 
 	// flush the graphics pipeline
 	glFlush();
 }
 
+// time frames with 1, 4 and 9 viewports at full resolution, without and with particles,
+// and print the results
+static void run_viewport_benchmark(GLFWwindow* window) {
+	const int warmupFrames = 60, measuredFrames = 300;
+
+	// uncapped, full resolution, nothing drawn on top
+	glfwSwapInterval(0);
+	bool dynamicResolution = gDynamicResolution,
+		 particlesEnabled = gParticlesEnabled;
+	gDynamicResolution = false;
+	gRenderScale = 1.0f;
+
+	// draw calls count the opaque items - particles are one draw per view that sees them,
+	// processing every live particle, so their cost is shown as vertices instead
+	cout << "viewports, particles, ms/frame, cpu ms/frame, draw calls/frame, particle vertices/frame" << endl;
+	for (int run = 0; run < 2 * gMaxViewGrid; run++) {
+		// opaque drawing alone first, then with the particles' per-view draws
+		gParticlesEnabled = run >= gMaxViewGrid;
+		int grid = run % gMaxViewGrid + 1;
+		gViewGrid = grid;
+		double totalTime = 0.0, cpuTime = 0.0, particleVertices = 0.0;
+
+		for (int frame = 0; frame < warmupFrames + measuredFrames; frame++) {
+			double start = glfwGetTime();
+			update_scene(window);
+			update_particles();
+			update_camera(window);
+			update_views(gWindowWidth, gWindowHeight);
+			render_scene(gWindowWidth, gWindowHeight);
+			double submitted = glfwGetTime();
+			glFinish();		// include the GPU's work in the frame time
+			glfwSwapBuffers(window);
+			glfwPollEvents();
+
+			if (frame >= warmupFrames) {
+				totalTime += glfwGetTime() - start;
+				cpuTime += submitted - start;
+				particleVertices += gParticleVertices;
+			}
+		}
+
+		cout << grid * grid << ", " << (gParticlesEnabled ? "on" : "off") << ", "
+			 << totalTime * 1000.0 / measuredFrames << ", "
+			 << cpuTime * 1000.0 / measuredFrames << ", " << gDrawCalls << ", "
+			 << particleVertices / measuredFrames << endl;
+	}
+
+	gViewGrid = 1;
+	gDynamicResolution = dynamicResolution;
+	gParticlesEnabled = particlesEnabled;
+	glfwSwapInterval(1);
+}
+
 // mouse movement callback function
 static void cursor_position_callback(GLFWwindow* window, 
 									 double xpos, double ypos) {
-	// pass cursor position to tweak bar
-	TwEventMousePosGLFW(static_cast<int>(xpos), static_cast<int>(ypos));
+	// pass cursor position to tweak bar, unless it is hidden
+	if (gShowUI)
+		TwEventMousePosGLFW(static_cast<int>(xpos), static_cast<int>(ypos));
 }
 
 // mouse button callback function
 static void mouse_button_callback(GLFWwindow* window, 
 								  int button, int action, int mods) {
-	// pass mouse button status to tweak bar
-	TwEventMouseButtonGLFW(button, action);
+	// pass mouse button status to tweak bar, unless it is hidden
+	if (gShowUI)
+		TwEventMouseButtonGLFW(button, action);
 }
 
 // key press or release callback function
@@ -410,6 +832,20 @@ static void key_callback(GLFWwindow* window, int key,
 		glfwSetWindowShouldClose(window, GL_TRUE);
 		return;
 	}
+
+	// toggle the tweak bar when F1 is pressed
+	if (key == GLFW_KEY_F1 && action == GLFW_PRESS)
+		gShowUI = !gShowUI;
+
+	// toggle the stats overlay when F2 is pressed
+	if (key == GLFW_KEY_F2 && action == GLFW_PRESS)
+		gShowOverlay = !gShowOverlay;
+}
+
+// mouse wheel callback function
+static void scroll_callback(GLFWwindow* window, double xoffset, double yoffset) {
+	// zoom in or out by 10% per notch
+	gZoom = glm::clamp(gZoom * static_cast<float>(pow(1.1, yoffset)), 0.25f, 4.0f);
 }
 
 // error callback function
@@ -418,9 +854,21 @@ static void error_callback(int error, const char* description)
 	cerr << description << endl;	// output error description
 }
 
-int main(void) {
+int main(int argc, char** argv) {
 	GLFWwindow* window = nullptr;	// GLFW window handle
 
+	// command line options - --no-overlay and --no-ui keep the stats overlay and tweak bar
+	// off for benchmark runs, --viewport-bench times 1, 4 and 9 viewports and exits
+	bool viewportBenchmark = false;
+	for (int i = 1; i < argc; i++) {
+		if (string(argv[i]) == "--no-overlay")
+			gShowOverlay = false;
+		else if (string(argv[i]) == "--no-ui")
+			gShowUI = false;
+		else if (string(argv[i]) == "--viewport-bench")
+			viewportBenchmark = true;
+	}
+
 	glfwSetErrorCallback(error_callback);	// set GLFW error callback function
 
 	// initialise GLFW
@@ -461,6 +909,7 @@ int main(void) {
 	glfwSetKeyCallback(window, key_callback);
 	glfwSetCursorPosCallback(window, cursor_position_callback);
 	glfwSetMouseButtonCallback(window, mouse_button_callback);
+	glfwSetScrollCallback(window, scroll_callback);
 
 	// avoid missing keyboard input
 	glfwSetInputMode(window, GLFW_STICKY_KEYS, GL_TRUE);
@@ -475,22 +924,57 @@ int main(void) {
 	// timing data
 	double lastUpdateTime = glfwGetTime();	// last update time
 	double elapsedTime = lastUpdateTime;	// time since last update
+	double lastFrameTime = lastUpdateTime;	// time the previous frame finished
 	int frameCount = 0;						// number of frames since last update
 
+	// benchmark instead of the interactive loop
+	if (viewportBenchmark) {
+		run_viewport_benchmark(window);
+		glfwSetWindowShouldClose(window, GL_TRUE);
+	}
+
 	// the rendering loop
 	while (!glfwWindowShouldClose(window))
 	{
 		update_scene(window);		// update scene (translations, rotation, etc.)
+		update_particles();			// emit and simulate particles on the GPU
+		update_camera(window);		// follow the truck, pan and zoom
+
+		// pick the render scale for this frame
+		if (gDynamicResolution) {
+			gResolution.update(gTargetSceneTime / 1000.0f, gMinScale, glm::max(gMinScale, gMaxScale));
+			gRenderScale = gResolution.getScale();
+			gSceneTime = gResolution.getSceneTime() * 1000.0f;
+		} else {
+			gRenderScale = 1.0f;
+		}
 
 		if (gWireframe)		// update render mode
 			glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
 
-		render_scene();		// render the scene
+		// size of the region the scene is rendered into
+		int targetWidth = gDynamicResolution ? gResolution.getScaledWidth() : gWindowWidth,
+			targetHeight = gDynamicResolution ? gResolution.getScaledHeight() : gWindowHeight;
+		update_views(targetWidth, targetHeight);	// cameras, shared instance data and culling
+
+		// render the scene - offscreen and upscaled when using dynamic resolution
+		if (gDynamicResolution)
+			gResolution.begin();
+		render_scene(targetWidth, targetHeight);
+		if (gDynamicResolution)
+			gResolution.end();
 
 		// prevent UI from rendering as wireframes
 		glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
 
-		TwDraw();			// draw tweak bar
+		// refresh and draw the stats overlay at native resolution
+		if (gShowOverlay) {
+			gOverlay.update(glfwGetTime(), gOverlayRefresh);
+			gOverlay.render();
+		}
+
+		if (gShowUI)
+			TwDraw();		// draw tweak bar at native resolution
 
 		glfwSwapBuffers(window);	// swap buffers
 		glfwPollEvents();			// poll for events
@@ -498,6 +982,12 @@ int main(void) {
 		frameCount++;
 		elapsedTime = glfwGetTime() - lastUpdateTime;	// time since last update
 
+		// individual frame times for the overlay's graph and histogram - recorded while
+		// hidden too, so it shows recent frames as soon as it is switched back on
+		double currentTime = glfwGetTime();
+		gOverlay.addFrame(static_cast<float>(currentTime - lastFrameTime));
+		lastFrameTime = currentTime;
+
 		// if elapsed time since last update > 1 second
 		if (elapsedTime > 1.0)
 		{
@@ -509,8 +999,11 @@ int main(void) {
 	}
 
 	// clean up
+	gWorkers.stop();
 	glDeleteBuffers(1, &gVBO);
 	glDeleteVertexArrays(1, &gVAO);
+	glDeleteBuffers(1, &gInstanceUBO);
+	glDeleteBuffers(1, &gCameraUBO);
 
 	// terminate tweak bar
 	TwDeleteBar(tweakBar);
@@ -0,0 +1,33 @@
+#include "Camera.h"
+
+#include <algorithm>
+#include <glm/gtx/transform.hpp>
+
+Camera::Camera(const glm::vec2& center, float halfHeight) : mCenter(center), mHalfHeight(halfHeight)
+{}
+
+// ease the centre towards a point - rate is roughly the fraction covered per second
+void Camera::follow(const glm::vec2& target, float rate, float deltaTime)
+{
+	mCenter += (target - mCenter) * std::min(rate * deltaTime, 1.0f);
+}
+
+glm::mat4 Camera::getViewMatrix() const
+{
+	return glm::translate(glm::vec3(-mCenter, 0.0f));
+}
+
+glm::mat4 Camera::getProjectionMatrix(float aspect) const
+{
+	// near/far are distances along -z, so z = CAMERA_NEAR_Z maps to depth 0
+	float halfWidth = mHalfHeight * aspect;
+	return glm::ortho(-halfWidth, halfWidth, -mHalfHeight, mHalfHeight, -CAMERA_NEAR_Z, -CAMERA_FAR_Z);
+}
+
+// visible world rectangle - x, y = lower left, z, w = upper right
+glm::vec4 Camera::getBounds(float aspect) const
+{
+	float halfWidth = mHalfHeight * aspect;
+	return glm::vec4(mCenter.x - halfWidth, mCenter.y - mHalfHeight,
+					 mCenter.x + halfWidth, mCenter.y + mHalfHeight);
+}
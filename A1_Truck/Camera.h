@@ -0,0 +1,38 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include <glm/glm.hpp>
+
+// 2D orthographic camera looking down the z-axis - larger z is nearer to the camera
+class Camera
+{
+public:
+	Camera(const glm::vec2& center = glm::vec2(0.0f), float halfHeight = 1.0f);
+
+	// ease the centre towards a point - rate is roughly the fraction covered per second
+	void follow(const glm::vec2& target, float rate, float deltaTime);
+
+	glm::mat4 getViewMatrix() const;
+	glm::mat4 getProjectionMatrix(float aspect) const;
+	// visible world rectangle - x, y = lower left, z, w = upper right
+	glm::vec4 getBounds(float aspect) const;
+
+	glm::vec2 mCenter;	// world point at the centre of the view
+	float mHalfHeight;	// half the visible height in world units (1 = whole scene as before)
+};
+
+// depth range covered by the projection - scene layers must lie inside
+const float CAMERA_NEAR_Z = 1.0f,
+			CAMERA_FAR_Z = -1.0f;
+
+// per-view camera data - std140 layout of CameraBlock in the shaders
+struct CameraData
+{
+	glm::mat4 viewMatrix;
+	glm::mat4 projectionMatrix;
+};
+
+// uniform buffer binding point CameraBlock is read from
+const unsigned int CAMERA_BLOCK_BINDING = 0;
+
+#endif
@@ -0,0 +1,134 @@
+#include "DynamicResolution.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+// controller tuning
+const float TIME_SMOOTHING = 0.1f,	// weight of the newest sample in the smoothed scene time
+			MAX_SCALE_STEP = 0.05f,	// largest scale change per frame
+			LOWER_BAND = 0.95f,		// no change while target / time stays within this band
+			UPPER_BAND = 1.1f;
+
+DynamicResolution::DynamicResolution()
+{}
+
+DynamicResolution::~DynamicResolution()
+{
+	// check if framebuffer exists
+	if (mFBO != 0)
+	{
+		// delete the framebuffer, its attachments and the queries
+		glDeleteFramebuffers(1, &mFBO);
+		glDeleteRenderbuffers(1, &mColorBuffer);
+		glDeleteRenderbuffers(1, &mDepthBuffer);
+		glDeleteQueries(3, mQueries);
+	}
+}
+
+// create the offscreen framebuffer at the full window size
+void DynamicResolution::init(int width, int height)
+{
+	mWidth = mScaledWidth = width;
+	mHeight = mScaledHeight = height;
+
+	// colour buffer at full size - smaller scales only render into its lower left region
+	glGenRenderbuffers(1, &mColorBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, mColorBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, mWidth, mHeight);
+
+	// depth buffer for the depth tested opaque pass
+	glGenRenderbuffers(1, &mDepthBuffer);
+	glBindRenderbuffer(GL_RENDERBUFFER, mDepthBuffer);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, mWidth, mHeight);
+
+	glGenFramebuffers(1, &mFBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, mFBO);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, mColorBuffer);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, mDepthBuffer);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		// output error message and exit
+		std::cerr << "Offscreen framebuffer incomplete" << std::endl;
+		exit(EXIT_FAILURE);
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glGenQueries(3, mQueries);
+}
+
+// adjust the render scale from the latest measured scene time
+void DynamicResolution::update(float targetFrameTime, float minScale, float maxScale)
+{
+	// read the oldest query - issued two frames ago so the result is normally ready
+	int oldest = (mFrame + 1) % 3;
+	if (mQueryIssued[oldest])
+	{
+		GLint available = GL_FALSE;
+		glGetQueryObjectiv(mQueries[oldest], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available)
+		{
+			GLuint64 nanoseconds = 0;
+			glGetQueryObjectui64v(mQueries[oldest], GL_QUERY_RESULT, &nanoseconds);
+			float sceneTime = nanoseconds * 1.0e-9f;
+			mSceneTime = mSceneTime > 0.0f ? mSceneTime + (sceneTime - mSceneTime) * TIME_SMOOTHING : sceneTime;
+			mQueryIssued[oldest] = false;
+		}
+	}
+
+	// fill cost follows pixel count, so the side length scales with the square root
+	if (mSceneTime > 0.0f)
+	{
+		float ratio = targetFrameTime / mSceneTime;
+		if (ratio < LOWER_BAND || ratio > UPPER_BAND)
+		{
+			float desired = mScale * std::sqrt(ratio);
+			mScale += std::min(std::max(desired - mScale, -MAX_SCALE_STEP), MAX_SCALE_STEP);
+		}
+	}
+	mScale = std::min(std::max(mScale, minScale), maxScale);
+
+	mScaledWidth = std::max(1, static_cast<int>(mWidth * mScale));
+	mScaledHeight = std::max(1, static_cast<int>(mHeight * mScale));
+}
+
+// redirect rendering into the scaled region of the offscreen framebuffer
+void DynamicResolution::begin()
+{
+	// time the scene pass, unless the slot's previous result has not been read yet
+	int current = mFrame % 3;
+	if (!mQueryIssued[current])
+		glBeginQuery(GL_TIME_ELAPSED, mQueries[current]);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, mFBO);
+	glViewport(0, 0, mScaledWidth, mScaledHeight);
+
+	// scissor so clears only touch the region in use
+	glEnable(GL_SCISSOR_TEST);
+	glScissor(0, 0, mScaledWidth, mScaledHeight);
+}
+
+// upscale the rendered region to the window with linear filtering
+void DynamicResolution::end()
+{
+	glDisable(GL_SCISSOR_TEST);
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, mFBO);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+	glBlitFramebuffer(0, 0, mScaledWidth, mScaledHeight, 0, 0, mWidth, mHeight,
+					  GL_COLOR_BUFFER_BIT, GL_LINEAR);
+
+	// back to the window at native resolution
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	glViewport(0, 0, mWidth, mHeight);
+
+	int current = mFrame % 3;
+	if (!mQueryIssued[current])
+	{
+		glEndQuery(GL_TIME_ELAPSED);
+		mQueryIssued[current] = true;
+	}
+	mFrame++;
+}
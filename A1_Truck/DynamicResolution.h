@@ -0,0 +1,43 @@
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+#include <GLEW/glew.h>
+
+// renders the scene into an offscreen framebuffer whose used region shrinks or grows
+// to keep the measured scene time near a target, then upscales it to the window
+class DynamicResolution
+{
+public:
+	DynamicResolution();
+	~DynamicResolution();
+
+	// create the offscreen framebuffer at the full window size
+	void init(int width, int height);
+	// adjust the render scale from the latest measured scene time
+	void update(float targetFrameTime, float minScale, float maxScale);
+	// redirect rendering into the scaled region of the offscreen framebuffer
+	void begin();
+	// upscale the rendered region to the window with linear filtering
+	void end();
+
+	float getScale() const { return mScale; }
+	// size of the region rendered this frame
+	int getScaledWidth() const { return mScaledWidth; }
+	int getScaledHeight() const { return mScaledHeight; }
+	// smoothed GPU time of the scene pass in seconds
+	float getSceneTime() const { return mSceneTime; }
+
+private:
+	GLuint mFBO = 0,			// offscreen framebuffer
+		   mColorBuffer = 0,	// colour attachment
+		   mDepthBuffer = 0;	// depth attachment
+	GLuint mQueries[3] = { 0, 0, 0 };			// timer queries, read a few frames late to avoid stalls
+	bool mQueryIssued[3] = { false, false, false };
+	int mWidth = 0, mHeight = 0;				// window size
+	int mScaledWidth = 0, mScaledHeight = 0;	// region rendered this frame
+	unsigned int mFrame = 0;
+	float mScale = 1.0f;
+	float mSceneTime = 0.0f;
+};
+
+#endif
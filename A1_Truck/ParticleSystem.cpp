@@ -0,0 +1,209 @@
+#include "ParticleSystem.h"
+#include "Camera.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// particle attribute format - interleaved, written back by the update shader in the same order
+struct Particle {
+	GLfloat pos[3],		// position - x,y,z
+			vel[3],		// velocity - x,y,z
+			state[3];	// age, life, type
+};
+
+// motion of the update shader (must match particleUpdate.vert) - used to bound where particles go
+const float EXHAUST_ACCELERATION = 0.08f,	// along y
+			EXHAUST_DRAG = 0.8f,
+			DUST_ACCELERATION = -0.6f,		// along y
+			SPAWN_JITTER = 0.01f;			// position offset around the emitter
+
+// box a particle spawned at the emitter can reach before it dies
+static glm::vec4 reach_bounds(const ParticleEmitter& emitter)
+{
+	bool exhaust = emitter.type < 0.5f;
+
+	// drag only slows particles down, so exhaust covers at most 1 / drag seconds of its velocity
+	float travel = exhaust ? std::min(emitter.life, 1.0f / EXHAUST_DRAG) : emitter.life;
+	glm::vec2 direction(emitter.direction);
+	glm::vec2 lower = glm::min((direction - emitter.spread) * travel, glm::vec2(0.0f)),
+			  upper = glm::max((direction + emitter.spread) * travel, glm::vec2(0.0f));
+
+	// acceleration along y
+	float drift = exhaust ? EXHAUST_ACCELERATION * emitter.life * travel
+						  : 0.5f * DUST_ACCELERATION * emitter.life * emitter.life;
+	lower.y += std::min(drift, 0.0f);
+	upper.y += std::max(drift, 0.0f);
+
+	glm::vec2 position(emitter.position);
+	return glm::vec4(position + lower - SPAWN_JITTER, position + upper + SPAWN_JITTER);
+}
+
+ParticleSystem::ParticleSystem() : mBounds(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX)
+{}
+
+ParticleSystem::~ParticleSystem()
+{
+	// check if buffers exist
+	if (mVBO[0] != 0)
+	{
+		// delete the buffers and vertex arrays
+		glDeleteBuffers(2, mVBO);
+		glDeleteVertexArrays(2, mVAO);
+	}
+}
+
+// create the ping-pong buffers and shader programs
+void ParticleSystem::init(unsigned int maxParticles)
+{
+	mMaxParticles = maxParticles;
+
+	// compile the simulation shader, capturing its outputs into the other buffer
+	mUpdateShader.compileAndLinkFeedback("particleUpdate.vert",
+		{ "tfPosition", "tfVelocity", "tfState" });
+	mRenderShader.compileAndLink("particle.vert", "particle.frag");
+	mRenderShader.setUniformBlock("CameraBlock", CAMERA_BLOCK_BINDING);
+
+	// all particles start dead (age = life = 0) and are spawned by the update shader
+	std::vector<Particle> particles(mMaxParticles, Particle{ { 0.0f, 0.0f, 0.0f },
+															 { 0.0f, 0.0f, 0.0f },
+															 { 0.0f, 0.0f, 0.0f } });
+
+	glGenBuffers(2, mVBO);
+	glGenVertexArrays(2, mVAO);
+
+	for (int i = 0; i < 2; i++) {
+		// create VBO and buffer the initial state
+		glBindBuffer(GL_ARRAY_BUFFER, mVBO[i]);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(Particle) * particles.size(), &particles[0], GL_DYNAMIC_COPY);
+
+		// the same VAO feeds the update shader and the render shader
+		glBindVertexArray(mVAO[i]);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Particle),
+			reinterpret_cast<void*>(offsetof(Particle, pos)));		// specify format of position data
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Particle),
+			reinterpret_cast<void*>(offsetof(Particle, vel)));		// specify format of velocity data
+		glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, sizeof(Particle),
+			reinterpret_cast<void*>(offsetof(Particle, state)));	// specify format of state data
+
+		glEnableVertexAttribArray(0);	// enable vertex attributes
+		glEnableVertexAttribArray(1);
+		glEnableVertexAttribArray(2);
+	}
+
+	glBindVertexArray(0);
+	mCurrent = 0;
+}
+
+// advance the live particles and spawn new ones at the emitters
+void ParticleSystem::update(const ParticleEmitter* emitters, int numEmitters, float deltaTime)
+{
+	numEmitters = std::min(numEmitters, MAX_PARTICLE_EMITTERS);
+	mTime += deltaTime;
+
+	// forget spawns whose particles have all died, their slots can be handed out again
+	mSpawns.erase(std::remove_if(mSpawns.begin(), mSpawns.end(),
+		[this](const Spawn& spawn) { return spawn.expires < mTime; }), mSpawns.end());
+
+	// whole particles due at each emitter, given the next slots of the ring in emitter order
+	unsigned long long spawnFirst = mSpawned;
+	int spawnCount[MAX_PARTICLE_EMITTERS] = {};
+	for (int i = 0; i < numEmitters; i++) {
+		mSpawnCarry[i] += emitters[i].rate * deltaTime;
+		unsigned int due = static_cast<unsigned int>(mSpawnCarry[i]);
+		mSpawnCarry[i] -= due;
+
+		// never more than the buffer holds in one frame
+		spawnCount[i] = static_cast<int>(std::min<unsigned long long>(due, mMaxParticles - (mSpawned - spawnFirst)));
+		if (spawnCount[i] > 0)
+			mSpawns.push_back({ reach_bounds(emitters[i]), mSpawned, mTime + emitters[i].life });
+		mSpawned += spawnCount[i];
+	}
+
+	// slots from the oldest spawn that may still be alive up to the newest - everything else is dead
+	unsigned long long oldest = mSpawns.empty() ? mSpawned : mSpawns.front().first;
+	mLiveCount = static_cast<unsigned int>(std::min<unsigned long long>(mSpawned - oldest, mMaxParticles));
+	mLiveFirst = static_cast<unsigned int>((mSpawned - mLiveCount) % mMaxParticles);
+
+	mUpdateShader.use();
+	mUpdateShader.setUniform("uDeltaTime", deltaTime);
+	mUpdateShader.setUniform("uFrame", mFrame++);
+	mUpdateShader.setUniform("uMaxParticles", static_cast<int>(mMaxParticles));
+	mUpdateShader.setUniform("uSpawnFirst", static_cast<int>(spawnFirst % mMaxParticles));
+	mUpdateShader.setUniform("uNumEmitters", numEmitters);
+
+	for (int i = 0; i < numEmitters; i++) {
+		std::string index = "[" + std::to_string(i) + "]";
+		mUpdateShader.setUniform(("uEmitterPosition" + index).c_str(), emitters[i].position);
+		mUpdateShader.setUniform(("uEmitterDirection" + index).c_str(), emitters[i].direction);
+		mUpdateShader.setUniform(("uEmitterSpread" + index).c_str(), emitters[i].spread);
+		mUpdateShader.setUniform(("uEmitterCount" + index).c_str(), spawnCount[i]);
+		mUpdateShader.setUniform(("uEmitterLife" + index).c_str(), emitters[i].life);
+		mUpdateShader.setUniform(("uEmitterType" + index).c_str(), emitters[i].type);
+	}
+
+	// read the live range of the current buffer, write it to the other one - nothing is rasterized.
+	// Slots outside the range are left stale, they are dead and only read again once respawned
+	glEnable(GL_RASTERIZER_DISCARD);
+	glBindVertexArray(mVAO[mCurrent]);
+	drawRange(mLiveFirst, mLiveCount, true);
+	glDisable(GL_RASTERIZER_DISCARD);
+
+	// the written buffer now holds the latest state
+	mCurrent = 1 - mCurrent;
+
+	// where the live particles can be
+	mBounds = glm::vec4(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+	for (const Spawn& spawn : mSpawns)
+		mBounds = glm::vec4(glm::min(glm::vec2(mBounds), glm::vec2(spawn.box)),
+							glm::max(glm::vec2(mBounds.z, mBounds.w), glm::vec2(spawn.box.z, spawn.box.w)));
+}
+
+// draw the live particles as points through the camera bound to CAMERA_BLOCK_BINDING
+void ParticleSystem::render(float pointScale)
+{
+	mRenderShader.use();
+	mRenderShader.setUniform("uPointScale", pointScale);
+
+	// soft points blended over the scene, sized in the vertex shader - depth tested, not written
+	glDepthMask(GL_FALSE);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	glEnable(GL_PROGRAM_POINT_SIZE);
+
+	glBindVertexArray(mVAO[mCurrent]);
+	drawRange(mLiveFirst, mLiveCount, false);
+
+	glDisable(GL_PROGRAM_POINT_SIZE);
+	glDisable(GL_BLEND);
+	glDepthMask(GL_TRUE);
+}
+
+// draw count slots from first, in two parts when the range wraps around the end of the buffer
+// (with feedback, each part is captured into the same slots of the other buffer)
+void ParticleSystem::drawRange(unsigned int first, unsigned int count, bool feedback)
+{
+	unsigned int partFirst[2] = { first, 0 },
+				 partCount[2] = { std::min(count, mMaxParticles - first), 0 };
+	partCount[1] = count - partCount[0];
+
+	for (int part = 0; part < 2; part++) {
+		if (partCount[part] == 0)
+			continue;
+
+		// gl_VertexID starts at partFirst, so the shader sees each particle's slot
+		if (feedback) {
+			glBindBufferRange(GL_TRANSFORM_FEEDBACK_BUFFER, 0, mVBO[1 - mCurrent],
+							  partFirst[part] * sizeof(Particle), partCount[part] * sizeof(Particle));
+			glBeginTransformFeedback(GL_POINTS);
+		}
+		glDrawArrays(GL_POINTS, partFirst[part], partCount[part]);
+		if (feedback)
+			glEndTransformFeedback();
+	}
+
+	if (feedback)
+		glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+}
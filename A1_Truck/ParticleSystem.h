@@ -0,0 +1,82 @@
+#ifndef PARTICLE_SYSTEM_H
+#define PARTICLE_SYSTEM_H
+
+#include <vector>
+#include <GLEW/glew.h>
+#include <glm/glm.hpp>
+#include "ShaderProgram.h"
+
+// maximum number of emitters handled by the update shader (must match particleUpdate.vert)
+const int MAX_PARTICLE_EMITTERS = 4;
+
+// particle types - selects motion and colour in the shaders
+const float PARTICLE_EXHAUST = 0.0f,
+			PARTICLE_DUST = 1.0f;
+
+// largest point size in pixels at a point scale of 1 (must match particle.vert)
+const float PARTICLE_MAX_POINT_SIZE = 10.0f;
+
+// a point particles are spawned from, set by the scene every frame
+struct ParticleEmitter
+{
+	glm::vec3 position;		// world position of the emitter
+	glm::vec3 direction;	// initial particle velocity
+	float spread;			// random velocity added around the direction
+	float rate;				// particles per second
+	float life;				// maximum particle lifetime in seconds
+	float type;				// PARTICLE_EXHAUST or PARTICLE_DUST
+};
+
+// particles simulated entirely on the GPU - state lives in two buffers that are
+// swapped every frame, one read as vertex input while the other is written with transform feedback.
+// Spawns take the next slots of a ring, so the live particles are one (possibly wrapping) range
+// and updating and drawing cost grows with the live count rather than the buffer size
+class ParticleSystem
+{
+public:
+	ParticleSystem();
+	~ParticleSystem();
+
+	// create the ping-pong buffers and shader programs
+	void init(unsigned int maxParticles);
+	// advance the live particles and spawn new ones at the emitters
+	void update(const ParticleEmitter* emitters, int numEmitters, float deltaTime);
+	// draw the live particles as points through the camera bound to CAMERA_BLOCK_BINDING
+	void render(float pointScale);
+
+	unsigned int getMaxParticles() const { return mMaxParticles; }
+	// particles processed by update and each render - spawned within the longest lifetime
+	unsigned int getLiveCount() const { return mLiveCount; }
+	// world box (min x, min y, max x, max y) holding every live particle, min > max when none can be alive
+	glm::vec4 getBounds() const { return mBounds; }
+
+private:
+	// particles spawned at one emitter in one frame - their slots and the box they can reach,
+	// kept until the longest such life has passed
+	struct Spawn {
+		glm::vec4 box;
+		unsigned long long first;	// spawn number of the first particle, the slot is this modulo the buffer size
+		float expires;
+	};
+
+	// draw count slots from first, in two parts when the range wraps around the end of the buffer
+	// (with feedback, each part is captured into the same slots of the other buffer)
+	void drawRange(unsigned int first, unsigned int count, bool feedback);
+
+	ShaderProgram mUpdateShader;	// transform feedback simulation
+	ShaderProgram mRenderShader;	// point rendering
+	GLuint mVBO[2] = { 0, 0 },		// particle state buffers
+		   mVAO[2] = { 0, 0 };		// vertex array object for each buffer
+	unsigned int mMaxParticles = 0;	// number of particles in each buffer
+	unsigned int mCurrent = 0;		// buffer holding the latest state
+	int mFrame = 0;					// seeds the random numbers in the update shader
+	float mTime = 0.0f;				// simulated time
+	unsigned long long mSpawned = 0;	// particles spawned so far - the next slot is this modulo the buffer size
+	unsigned int mLiveFirst = 0,	// range of slots that may hold live particles
+				 mLiveCount = 0;
+	float mSpawnCarry[MAX_PARTICLE_EMITTERS] = {};	// fractional particles owed to each emitter
+	std::vector<Spawn> mSpawns;		// recent spawns whose particles may still be alive, oldest first
+	glm::vec4 mBounds;				// union of the boxes of mSpawns
+};
+
+#endif
@@ -16,116 +16,102 @@ ShaderProgram::~ShaderProgram()
 // compile and link a vertex and fragment shader pair
 void ShaderProgram::compileAndLink(const std::string vShaderFilename, const std::string fShaderFilename)
 {
-	GLint status;	// used for checking compile and link status
-
-/****************************************************************
- * Step 1: read vertex and fragment shader source code from files
- ****************************************************************/
-	std::string vShaderString;	// to store vertex shader code
-	std::string fShaderString;	// to store fragment shader code
-	std::ifstream vShaderFile(vShaderFilename, std::ios::in); 	// open file
-	std::ifstream fShaderFile(fShaderFilename, std::ios::in); 	// open file
-
-	// if file successfully opened, get the shader source code
-	if (vShaderFile.is_open())
-	{
-		std::stringstream stream;
-		stream << vShaderFile.rdbuf();	// read buffer contents
-		vShaderString = stream.str();	// convert stream into string
-		vShaderFile.close();			// close file
-	}
-	else
-	{
-		// output error message and exit
-		std::cerr << "Failed to open: " << vShaderFilename << std::endl;
-		exit(EXIT_FAILURE);
-	}
+	// read and compile the shaders
+	GLuint vShaderID = compileShader(GL_VERTEX_SHADER, vShaderFilename);
+	GLuint fShaderID = compileShader(GL_FRAGMENT_SHADER, fShaderFilename);
 
-	// if file successfully opened, get the shader source code
-	if (fShaderFile.is_open())
-	{
-		std::stringstream stream;
-		stream << fShaderFile.rdbuf();	// read buffer contents
-		fShaderString = stream.str();	// convert stream into string
-		fShaderFile.close();			// close file
-	}
-	else
-	{
-		// output error message and exit
-		std::cerr << "Failed to open: " << fShaderFilename << std::endl;
-		exit(EXIT_FAILURE);
-	}
+	// create program object and attach the shaders
+	mProgramID = glCreateProgram();
+	glAttachShader(mProgramID, vShaderID);
+	glAttachShader(mProgramID, fShaderID);
 
-/****************************************************************
- * Step 2: Create and compile shader objects
- ****************************************************************/
-	 // create shader objects
-	GLuint vShaderID = glCreateShader(GL_VERTEX_SHADER);
-	GLuint fShaderID = glCreateShader(GL_FRAGMENT_SHADER);
+	linkProgram();
 
-	// provide source code for shaders
-	const GLchar *vShaderCode = vShaderString.c_str();
-	const GLchar *fShaderCode = fShaderString.c_str();
-	glShaderSource(vShaderID, 1, &vShaderCode, nullptr);
-	glShaderSource(fShaderID, 1, &fShaderCode, nullptr);
+	// flag shaders for deletion (will not actually be deleted until detached from program)
+	glDeleteShader(vShaderID);
+	glDeleteShader(fShaderID);
+}
 
-	// compile shaders
-	glCompileShader(vShaderID);
-	glCompileShader(fShaderID);
+// compile and link a vertex shader whose outputs are captured with transform feedback
+void ShaderProgram::compileAndLinkFeedback(const std::string vShaderFilename, const std::vector<std::string>& varyings)
+{
+	// read and compile the shader
+	GLuint vShaderID = compileShader(GL_VERTEX_SHADER, vShaderFilename);
 
-	// check vertex shader compile status
-	status = GL_FALSE;
-	glGetShaderiv(vShaderID, GL_COMPILE_STATUS, &status);
+	// create program object and attach the shader
+	mProgramID = glCreateProgram();
+	glAttachShader(mProgramID, vShaderID);
 
-	if (status == GL_FALSE)
-	{
-		// output error message
-		std::cerr << "Failed to compile " << vShaderFilename << std::endl;
+	// outputs written interleaved into a single feedback buffer (must be set before linking)
+	std::vector<const GLchar*> names;
+	for (const std::string& varying : varyings)
+		names.push_back(varying.c_str());
+	glTransformFeedbackVaryings(mProgramID, static_cast<GLsizei>(names.size()), names.data(), GL_INTERLEAVED_ATTRIBS);
 
-		// output error log
-		int infoLogLength;
-		glGetShaderiv(vShaderID, GL_INFO_LOG_LENGTH, &infoLogLength);
-		std::string errorMessage(infoLogLength, ' ');
-		glGetShaderInfoLog(vShaderID, infoLogLength, nullptr, &errorMessage[0]);
-		std::cerr << errorMessage << std::endl;
+	linkProgram();
+
+	// flag shader for deletion (will not actually be deleted until detached from program)
+	glDeleteShader(vShaderID);
+}
 
+// read shader source code from a file, exit if it cannot be opened
+std::string ShaderProgram::readFile(const std::string& filename)
+{
+	std::ifstream file(filename, std::ios::in); 	// open file
+
+	// if file could not be opened, output error message and exit
+	if (!file.is_open())
+	{
+		std::cerr << "Failed to open: " << filename << std::endl;
 		exit(EXIT_FAILURE);
 	}
 
-	// check fragment shader compile status
-	status = GL_FALSE;
-	glGetShaderiv(fShaderID, GL_COMPILE_STATUS, &status);
+	// get the shader source code
+	std::stringstream stream;
+	stream << file.rdbuf();	// read buffer contents
+	return stream.str();	// convert stream into string
+}
+
+// create and compile a shader object from a file, exit with the error log if compiling fails
+GLuint ShaderProgram::compileShader(GLenum type, const std::string& filename)
+{
+	std::string shaderString = readFile(filename);
+
+	// create shader object, provide its source code and compile it
+	GLuint shaderID = glCreateShader(type);
+	const GLchar *shaderCode = shaderString.c_str();
+	glShaderSource(shaderID, 1, &shaderCode, nullptr);
+	glCompileShader(shaderID);
+
+	// check compile status
+	GLint status = GL_FALSE;
+	glGetShaderiv(shaderID, GL_COMPILE_STATUS, &status);
 
 	if (status == GL_FALSE)
 	{
 		// output error message
-		std::cerr << "Failed to compile " << fShaderFilename << std::endl;
+		std::cerr << "Failed to compile " << filename << std::endl;
 
 		// output error log
 		int infoLogLength;
-		glGetShaderiv(fShaderID, GL_INFO_LOG_LENGTH, &infoLogLength);
+		glGetShaderiv(shaderID, GL_INFO_LOG_LENGTH, &infoLogLength);
 		std::string errorMessage(infoLogLength, ' ');
-		glGetShaderInfoLog(fShaderID, infoLogLength, nullptr, &errorMessage[0]);
+		glGetShaderInfoLog(shaderID, infoLogLength, nullptr, &errorMessage[0]);
 		std::cerr << errorMessage << std::endl;
 
 		exit(EXIT_FAILURE);
 	}
 
-/****************************************************************
- * Step 3: Attach shaders to program object and link
- ****************************************************************/
-	// create program object
-	mProgramID = glCreateProgram();
-
-	// attach shaders to the program object
-	glAttachShader(mProgramID, vShaderID);
-	glAttachShader(mProgramID, fShaderID);
+	return shaderID;
+}
 
-	// link program object
+// link the program object, exit with the error log if linking fails
+void ShaderProgram::linkProgram()
+{
 	glLinkProgram(mProgramID);
 
 	// check link status
-	status = GL_FALSE;
+	GLint status = GL_FALSE;
 	glGetProgramiv(mProgramID, GL_LINK_STATUS, &status);
 
 	if (status == GL_FALSE)
@@ -135,17 +121,13 @@ void ShaderProgram::compileAndLink(const std::string vShaderFilename, const std:
 
 		// output error log
 		int infoLogLength;
-		glGetShaderiv(mProgramID, GL_INFO_LOG_LENGTH, &infoLogLength);
+		glGetProgramiv(mProgramID, GL_INFO_LOG_LENGTH, &infoLogLength);
 		std::string errorMessage(infoLogLength, ' ');
-		glGetShaderInfoLog(mProgramID, infoLogLength, nullptr, &errorMessage[0]);
+		glGetProgramInfoLog(mProgramID, infoLogLength, nullptr, &errorMessage[0]);
 		std::cerr << errorMessage << std::endl;
 
 		exit(EXIT_FAILURE);
 	}
-
-	// flag shaders for deletion (will not actually be deleted until detached from program)
-	glDeleteShader(vShaderID);
-	glDeleteShader(fShaderID);
 }
 
 // use the shader program
@@ -195,6 +177,16 @@ void ShaderProgram::setUniform(const char *name, bool value)
 	glUniform1i(getUniformLocation(name), value);
 }
 
+// connect a uniform block to a buffer binding point
+void ShaderProgram::setUniformBlock(const char *name, GLuint binding)
+{
+	GLuint index = glGetUniformBlockIndex(mProgramID, name);
+
+	// blocks unused by the shaders are optimised away
+	if (index != GL_INVALID_INDEX)
+		glUniformBlockBinding(mProgramID, index, binding);
+}
+
 // get uniform variable locations
 GLint ShaderProgram::getUniformLocation(const char *name)
 {
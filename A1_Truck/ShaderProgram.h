@@ -6,6 +6,7 @@
 #include <sstream> 
 #include <string>
 #include <map>
+#include <vector>
 #include <GLEW/glew.h>
 #include <glm/glm.hpp>
 
@@ -17,6 +18,8 @@ public:
 
 	// compile and link a vertex and fragment shader pair
 	void compileAndLink(const std::string vShaderFilename, const std::string fShaderFilename);
+	// compile and link a vertex shader whose outputs are captured with transform feedback
+	void compileAndLinkFeedback(const std::string vShaderFilename, const std::vector<std::string>& varyings);
 	// use the shader program
 	void use();
 
@@ -29,12 +32,19 @@ public:
 	void setUniform(const char *name, float value);
 	void setUniform(const char *name, int value);
 	void setUniform(const char *name, bool value);
+	// connect a uniform block to a buffer binding point
+	void setUniformBlock(const char *name, GLuint binding);
 
 private:
 	GLuint mProgramID = 0;							// shader program handle
 	std::map<std::string, GLint> mUniformLocations;	// uniform locations
 
 	GLint getUniformLocation(const char *name);		// get uniform variable locations
+
+	// shared by compileAndLink and compileAndLinkFeedback - exit with the error log on failure
+	static std::string readFile(const std::string& filename);
+	static GLuint compileShader(GLenum type, const std::string& filename);
+	void linkProgram();
 };
 
 #endif
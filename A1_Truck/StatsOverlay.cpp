@@ -0,0 +1,345 @@
+#include "StatsOverlay.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+
+// 5x7 bitmap font - upper case text only, other characters are drawn as spaces
+struct Glyph {
+	char c;
+	const char* rows[7];
+};
+
+const Glyph FONT[] = {
+	{ ' ', { "     ", "     ", "     ", "     ", "     ", "     ", "     " } },
+	{ '0', { " ### ", "#   #", "#  ##", "# # #", "##  #", "#   #", " ### " } },
+	{ '1', { "  #  ", " ##  ", "  #  ", "  #  ", "  #  ", "  #  ", " ### " } },
+	{ '2', { " ### ", "#   #", "    #", "   # ", "  #  ", " #   ", "#####" } },
+	{ '3', { "#####", "   # ", "  #  ", "   # ", "    #", "#   #", " ### " } },
+	{ '4', { "   # ", "  ## ", " # # ", "#  # ", "#####", "   # ", "   # " } },
+	{ '5', { "#####", "#    ", "#### ", "    #", "    #", "#   #", " ### " } },
+	{ '6', { "  ## ", " #   ", "#    ", "#### ", "#   #", "#   #", " ### " } },
+	{ '7', { "#####", "    #", "   # ", "  #  ", " #   ", " #   ", " #   " } },
+	{ '8', { " ### ", "#   #", "#   #", " ### ", "#   #", "#   #", " ### " } },
+	{ '9', { " ### ", "#   #", "#   #", " ####", "    #", "   # ", " ##  " } },
+	{ 'A', { " ### ", "#   #", "#   #", "#####", "#   #", "#   #", "#   #" } },
+	{ 'B', { "#### ", "#   #", "#   #", "#### ", "#   #", "#   #", "#### " } },
+	{ 'C', { " ### ", "#   #", "#    ", "#    ", "#    ", "#   #", " ### " } },
+	{ 'D', { "#### ", "#   #", "#   #", "#   #", "#   #", "#   #", "#### " } },
+	{ 'E', { "#####", "#    ", "#    ", "#### ", "#    ", "#    ", "#####" } },
+	{ 'F', { "#####", "#    ", "#    ", "#### ", "#    ", "#    ", "#    " } },
+	{ 'G', { " ### ", "#   #", "#    ", "# ###", "#   #", "#   #", " ####" } },
+	{ 'H', { "#   #", "#   #", "#   #", "#####", "#   #", "#   #", "#   #" } },
+	{ 'I', { " ### ", "  #  ", "  #  ", "  #  ", "  #  ", "  #  ", " ### " } },
+	{ 'J', { "  ###", "   # ", "   # ", "   # ", "   # ", "#  # ", " ##  " } },
+	{ 'K', { "#   #", "#  # ", "# #  ", "##   ", "# #  ", "#  # ", "#   #" } },
+	{ 'L', { "#    ", "#    ", "#    ", "#    ", "#    ", "#    ", "#####" } },
+	{ 'M', { "#   #", "## ##", "# # #", "# # #", "#   #", "#   #", "#   #" } },
+	{ 'N', { "#   #", "#   #", "##  #", "# # #", "#  ##", "#   #", "#   #" } },
+	{ 'O', { " ### ", "#   #", "#   #", "#   #", "#   #", "#   #", " ### " } },
+	{ 'P', { "#### ", "#   #", "#   #", "#### ", "#    ", "#    ", "#    " } },
+	{ 'Q', { " ### ", "#   #", "#   #", "#   #", "# # #", "#  # ", " ## #" } },
+	{ 'R', { "#### ", "#   #", "#   #", "#### ", "# #  ", "#  # ", "#   #" } },
+	{ 'S', { " ####", "#    ", "#    ", " ### ", "    #", "    #", "#### " } },
+	{ 'T', { "#####", "  #  ", "  #  ", "  #  ", "  #  ", "  #  ", "  #  " } },
+	{ 'U', { "#   #", "#   #", "#   #", "#   #", "#   #", "#   #", " ### " } },
+	{ 'V', { "#   #", "#   #", "#   #", "#   #", "#   #", " # # ", "  #  " } },
+	{ 'W', { "#   #", "#   #", "#   #", "# # #", "# # #", "# # #", " # # " } },
+	{ 'X', { "#   #", "#   #", " # # ", "  #  ", " # # ", "#   #", "#   #" } },
+	{ 'Y', { "#   #", "#   #", " # # ", "  #  ", "  #  ", "  #  ", "  #  " } },
+	{ 'Z', { "#####", "    #", "   # ", "  #  ", " #   ", "#    ", "#####" } },
+	{ '.', { "     ", "     ", "     ", "     ", "     ", " ##  ", " ##  " } },
+	{ ':', { "     ", " ##  ", " ##  ", "     ", " ##  ", " ##  ", "     " } },
+	{ '-', { "     ", "     ", "     ", "#####", "     ", "     ", "     " } },
+	{ '%', { "##   ", "##  #", "   # ", "  #  ", " #   ", "#  ##", "   ##" } },
+	{ '/', { "     ", "    #", "   # ", "  #  ", " #   ", "#    ", "     " } },
+	{ '(', { "   # ", "  #  ", " #   ", " #   ", " #   ", "  #  ", "   # " } },
+	{ ')', { " #   ", "  #  ", "   # ", "   # ", "   # ", "  #  ", " #   " } },
+	{ '=', { "     ", "     ", "#####", "     ", "#####", "     ", "     " } },
+};
+const int FONT_GLYPHS = sizeof(FONT) / sizeof(FONT[0]);
+
+// atlas layout - cell 0 is solid white for graph bars and the panel, glyphs follow
+const int GLYPH_WIDTH = 5, GLYPH_HEIGHT = 7,
+		  CELL_WIDTH = 6, CELL_HEIGHT = 8,
+		  ATLAS_COLUMNS = 16,
+		  ATLAS_ROWS = (FONT_GLYPHS + 1 + ATLAS_COLUMNS - 1) / ATLAS_COLUMNS,
+		  ATLAS_WIDTH = ATLAS_COLUMNS * CELL_WIDTH,
+		  ATLAS_HEIGHT = ATLAS_ROWS * CELL_HEIGHT,
+		  SOLID = -1;
+
+// layout in pixels
+const int TEXT_SCALE = 2,
+		  LINE_HEIGHT = (GLYPH_HEIGHT + 2) * TEXT_SCALE,
+		  MARGIN = 10,
+		  PANEL_WIDTH = OVERLAY_SAMPLES + 2 * MARGIN,
+		  GRAPH_HEIGHT = 60,
+		  HISTOGRAM_HEIGHT = 40;
+
+// colours
+const GLubyte PANEL_COLOR[4] = { 0, 0, 0, 160 },
+			  TEXT_COLOR[4] = { 255, 255, 255, 255 },
+			  GOOD_COLOR[4] = { 80, 220, 80, 255 },
+			  SLOW_COLOR[4] = { 240, 200, 60, 255 },
+			  BAD_COLOR[4] = { 240, 70, 60, 255 },
+			  REFERENCE_COLOR[4] = { 255, 255, 255, 96 },
+			  HISTOGRAM_COLOR[4] = { 80, 180, 240, 255 };
+
+StatsOverlay::StatsOverlay()
+{}
+
+StatsOverlay::~StatsOverlay()
+{
+	// check if buffers exist
+	if (mVBO != 0)
+	{
+		// delete the buffer, vertex array and atlas
+		glDeleteBuffers(1, &mVBO);
+		glDeleteVertexArrays(1, &mVAO);
+		glDeleteTextures(1, &mFontAtlas);
+	}
+}
+
+// create the font atlas, vertex buffer and shaders
+void StatsOverlay::init(int width, int height)
+{
+	mWidth = width;
+	mHeight = height;
+
+	mShader.compileAndLink("overlay.vert", "overlay.frag");
+	createFontAtlas();
+
+	// create VBO - filled when the displayed values change
+	glGenBuffers(1, &mVBO);
+	glBindBuffer(GL_ARRAY_BUFFER, mVBO);
+
+	// create VAO, specify VBO data and format of the data
+	glGenVertexArrays(1, &mVAO);
+	glBindVertexArray(mVAO);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+		reinterpret_cast<void*>(offsetof(Vertex, pos)));		// specify format of position data
+	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+		reinterpret_cast<void*>(offsetof(Vertex, uv)));		// specify format of atlas coordinates
+	glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(Vertex),
+		reinterpret_cast<void*>(offsetof(Vertex, color)));	// specify format of colour data
+
+	glEnableVertexAttribArray(0);	// enable vertex attributes
+	glEnableVertexAttribArray(1);
+	glEnableVertexAttribArray(2);
+	glBindVertexArray(0);
+}
+
+// rasterize the font into a single channel texture
+void StatsOverlay::createFontAtlas()
+{
+	std::vector<GLubyte> pixels(ATLAS_WIDTH * ATLAS_HEIGHT, 0);
+
+	// solid cell
+	for (int y = 0; y < CELL_HEIGHT; y++)
+		for (int x = 0; x < CELL_WIDTH; x++)
+			pixels[y * ATLAS_WIDTH + x] = 255;
+
+	// glyph cells, unknown characters map to the space glyph
+	std::fill(mGlyphIndex, mGlyphIndex + 128, 0);
+	for (int g = 0; g < FONT_GLYPHS; g++) {
+		int cell = g + 1,
+			cellX = (cell % ATLAS_COLUMNS) * CELL_WIDTH,
+			cellY = (cell / ATLAS_COLUMNS) * CELL_HEIGHT;
+		mGlyphIndex[static_cast<unsigned char>(FONT[g].c)] = g;
+
+		for (int y = 0; y < GLYPH_HEIGHT; y++)
+			for (int x = 0; x < GLYPH_WIDTH; x++)
+				if (FONT[g].rows[y][x] == '#')
+					pixels[(cellY + y) * ATLAS_WIDTH + cellX + x] = 255;
+	}
+
+	glGenTextures(1, &mFontAtlas);
+	glBindTexture(GL_TEXTURE_2D, mFontAtlas);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, ATLAS_WIDTH, ATLAS_HEIGHT, 0, GL_RED, GL_UNSIGNED_BYTE, &pixels[0]);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+// record the time of the last frame
+void StatsOverlay::addFrame(float frameTime)
+{
+	mSamples[mNextSample] = frameTime;
+	mNextSample = (mNextSample + 1) % OVERLAY_SAMPLES;
+	mSampleCount = std::min(mSampleCount + 1, OVERLAY_SAMPLES);
+}
+
+// recompute the displayed values every refreshInterval seconds, rebuild geometry if they changed
+void StatsOverlay::update(double time, float refreshInterval)
+{
+	if (mSampleCount == 0 || (mLastRefresh >= 0.0 && time - mLastRefresh < refreshInterval))
+		return;
+	mLastRefresh = time;
+
+	// samples oldest first
+	std::vector<float> samples(mSampleCount);
+	int oldest = (mSampleCount == OVERLAY_SAMPLES) ? mNextSample : 0;
+	for (int i = 0; i < mSampleCount; i++)
+		samples[i] = mSamples[(oldest + i) % OVERLAY_SAMPLES];
+
+	Display display;
+
+	// graph bars and histogram buckets, clamped to the top of the range
+	std::vector<int> counts(OVERLAY_BUCKETS, 0);
+	float total = 0.0f;
+	for (float sample : samples) {
+		float fraction = std::min(sample / OVERLAY_GRAPH_MAX, 1.0f);
+		display.graph.push_back(static_cast<int>(std::lround(fraction * GRAPH_HEIGHT)));
+		counts[std::min(static_cast<int>(fraction * OVERLAY_BUCKETS), OVERLAY_BUCKETS - 1)]++;
+		total += sample;
+	}
+	int maxCount = *std::max_element(counts.begin(), counts.end());
+	for (int count : counts)
+		display.histogram.push_back(count * HISTOGRAM_HEIGHT / maxCount);
+
+	// text - averages and spread over the buffer
+	std::vector<float> sorted(samples);
+	std::sort(sorted.begin(), sorted.end());
+	float average = total / mSampleCount,
+		  p99 = sorted[std::min(mSampleCount - 1, mSampleCount * 99 / 100)];
+
+	char line[64];
+	snprintf(line, sizeof(line), "FPS %.1f", 1.0f / average);
+	display.lines.push_back(line);
+	snprintf(line, sizeof(line), "FRAME %.2f MS", average * 1000.0f);
+	display.lines.push_back(line);
+	snprintf(line, sizeof(line), "MIN %.1f MAX %.1f", sorted.front() * 1000.0f, sorted.back() * 1000.0f);
+	display.lines.push_back(line);
+	snprintf(line, sizeof(line), "P99 %.1f MS", p99 * 1000.0f);
+	display.lines.push_back(line);
+
+	// nothing on screen would change
+	if (mVertexCount > 0 && display == mDisplay)
+		return;
+
+	mDisplay = display;
+	rebuild();
+}
+
+// build all geometry from the displayed values and upload it in one go
+void StatsOverlay::rebuild()
+{
+	mVertices.clear();
+
+	float left = static_cast<float>(mWidth - PANEL_WIDTH - MARGIN),
+		  top = static_cast<float>(MARGIN),
+		  textHeight = static_cast<float>(mDisplay.lines.size() * LINE_HEIGHT),
+		  panelHeight = MARGIN + textHeight + GRAPH_HEIGHT + MARGIN + HISTOGRAM_HEIGHT + MARGIN;
+
+	// background panel
+	addQuad(left, top, static_cast<float>(PANEL_WIDTH), panelHeight, SOLID, PANEL_COLOR);
+
+	// text
+	float y = top + MARGIN;
+	for (const std::string& text : mDisplay.lines) {
+		addText(left + MARGIN, y, text, TEXT_COLOR);
+		y += LINE_HEIGHT;
+	}
+
+	// frame time graph - one pixel wide bar per frame, newest on the right, line at half range
+	float graphBottom = y + GRAPH_HEIGHT,
+		  graphLeft = left + MARGIN + (OVERLAY_SAMPLES - mDisplay.graph.size());
+	for (size_t i = 0; i < mDisplay.graph.size(); i++) {
+		int height = mDisplay.graph[i];
+		const GLubyte* color = (height >= GRAPH_HEIGHT) ? BAD_COLOR
+							 : (height > GRAPH_HEIGHT / 2) ? SLOW_COLOR : GOOD_COLOR;
+		addQuad(graphLeft + i, graphBottom - height, 1.0f, static_cast<float>(height), SOLID, color);
+	}
+	addQuad(left + MARGIN, graphBottom - GRAPH_HEIGHT / 2, static_cast<float>(OVERLAY_SAMPLES), 1.0f,
+			SOLID, REFERENCE_COLOR);
+
+	// histogram of the same frames
+	float histogramBottom = graphBottom + MARGIN + HISTOGRAM_HEIGHT,
+		  bucketWidth = static_cast<float>(OVERLAY_SAMPLES) / OVERLAY_BUCKETS;
+	for (int i = 0; i < OVERLAY_BUCKETS; i++) {
+		int height = mDisplay.histogram[i];
+		addQuad(left + MARGIN + i * bucketWidth, histogramBottom - height, bucketWidth - 2.0f,
+				static_cast<float>(height), SOLID, HISTOGRAM_COLOR);
+	}
+
+	// upload the whole batch
+	mVertexCount = static_cast<GLsizei>(mVertices.size());
+	glBindBuffer(GL_ARRAY_BUFFER, mVBO);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * mVertices.size(), &mVertices[0], GL_DYNAMIC_DRAW);
+}
+
+// two triangles covering a rectangle - glyph SOLID samples the white cell
+void StatsOverlay::addQuad(float x, float y, float w, float h, int glyph, const GLubyte color[4])
+{
+	float u0, v0, u1, v1;
+	if (glyph == SOLID) {
+		// centre of the white cell, so every corner samples white
+		u0 = u1 = (CELL_WIDTH * 0.5f) / ATLAS_WIDTH;
+		v0 = v1 = (CELL_HEIGHT * 0.5f) / ATLAS_HEIGHT;
+	} else {
+		int cell = glyph + 1;
+		u0 = static_cast<float>((cell % ATLAS_COLUMNS) * CELL_WIDTH) / ATLAS_WIDTH;
+		v0 = static_cast<float>((cell / ATLAS_COLUMNS) * CELL_HEIGHT) / ATLAS_HEIGHT;
+		u1 = u0 + static_cast<float>(GLYPH_WIDTH) / ATLAS_WIDTH;
+		v1 = v0 + static_cast<float>(GLYPH_HEIGHT) / ATLAS_HEIGHT;
+	}
+
+	Vertex corners[4] = {
+		{ { x, y }, { u0, v0 }, { color[0], color[1], color[2], color[3] } },				// top left
+		{ { x + w, y }, { u1, v0 }, { color[0], color[1], color[2], color[3] } },			// top right
+		{ { x, y + h }, { u0, v1 }, { color[0], color[1], color[2], color[3] } },			// bot left
+		{ { x + w, y + h }, { u1, v1 }, { color[0], color[1], color[2], color[3] } },		// bot right
+	};
+
+	mVertices.push_back(corners[0]);
+	mVertices.push_back(corners[2]);
+	mVertices.push_back(corners[1]);
+	mVertices.push_back(corners[1]);
+	mVertices.push_back(corners[2]);
+	mVertices.push_back(corners[3]);
+}
+
+// one quad per character, upper case only
+void StatsOverlay::addText(float x, float y, const std::string& text, const GLubyte color[4])
+{
+	for (char c : text) {
+		int glyph = mGlyphIndex[std::toupper(static_cast<unsigned char>(c)) & 127];
+		// spaces need no geometry
+		if (FONT[glyph].c != ' ')
+			addQuad(x, y, static_cast<float>(GLYPH_WIDTH * TEXT_SCALE), static_cast<float>(GLYPH_HEIGHT * TEXT_SCALE),
+					glyph, color);
+		x += CELL_WIDTH * TEXT_SCALE;
+	}
+}
+
+// draw the overlay over whatever is in the framebuffer
+void StatsOverlay::render()
+{
+	if (mVertexCount == 0)
+		return;
+
+	mShader.use();
+	mShader.setUniform("uScreenSize", glm::vec2(static_cast<float>(mWidth), static_cast<float>(mHeight)));
+	mShader.setUniform("uFontAtlas", 0);
+
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, mFontAtlas);
+
+	// alpha blended on top of the scene
+	glDisable(GL_DEPTH_TEST);
+	glEnable(GL_BLEND);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	// the whole overlay in one draw call
+	glBindVertexArray(mVAO);
+	glDrawArrays(GL_TRIANGLES, 0, mVertexCount);
+
+	glDisable(GL_BLEND);
+	glEnable(GL_DEPTH_TEST);
+}
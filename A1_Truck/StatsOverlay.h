@@ -0,0 +1,75 @@
+#ifndef STATS_OVERLAY_H
+#define STATS_OVERLAY_H
+
+#include <string>
+#include <vector>
+#include <GLEW/glew.h>
+#include "ShaderProgram.h"
+
+// number of frames kept for the graph and histogram
+const int OVERLAY_SAMPLES = 240;
+// histogram buckets covering 0 to OVERLAY_GRAPH_MAX
+const int OVERLAY_BUCKETS = 20;
+// frame time at the top of the graph and histogram (seconds)
+const float OVERLAY_GRAPH_MAX = 1.0f / 30.0f;
+
+// frame time overlay - text, graph and histogram from a rolling buffer of frame times,
+// batched into one vertex buffer drawn with a single call and rebuilt only when it changes
+class StatsOverlay
+{
+public:
+	StatsOverlay();
+	~StatsOverlay();
+
+	// create the font atlas, vertex buffer and shaders
+	void init(int width, int height);
+	// record the time of the last frame
+	void addFrame(float frameTime);
+	// recompute the displayed values every refreshInterval seconds, rebuild geometry if they changed
+	void update(double time, float refreshInterval);
+	// draw the overlay over whatever is in the framebuffer
+	void render();
+
+private:
+	// what is on screen - compared to decide whether to rebuild
+	struct Display {
+		std::vector<std::string> lines;		// text lines
+		std::vector<int> graph;				// bar heights in pixels, oldest first
+		std::vector<int> histogram;			// bucket heights in pixels
+
+		bool operator==(const Display& other) const {
+			return lines == other.lines && graph == other.graph && histogram == other.histogram;
+		}
+	};
+
+	// overlay vertex - pixel position, atlas coordinate and colour
+	struct Vertex {
+		GLfloat pos[2],
+				uv[2];
+		GLubyte color[4];
+	};
+
+	void createFontAtlas();
+	void rebuild();
+	void addQuad(float x, float y, float w, float h, int glyph, const GLubyte color[4]);
+	void addText(float x, float y, const std::string& text, const GLubyte color[4]);
+
+	ShaderProgram mShader;
+	GLuint mVBO = 0,
+		   mVAO = 0,
+		   mFontAtlas = 0;
+	int mWidth = 0, mHeight = 0;
+
+	// rolling buffer of frame times
+	float mSamples[OVERLAY_SAMPLES] = {};
+	int mNextSample = 0,
+		mSampleCount = 0;
+
+	double mLastRefresh = -1.0;
+	Display mDisplay;
+	std::vector<Vertex> mVertices;		// geometry built on the CPU, uploaded on rebuild
+	GLsizei mVertexCount = 0;			// vertices in the buffer
+	int mGlyphIndex[128];				// atlas cell of each ASCII character
+};
+
+#endif
@@ -0,0 +1,231 @@
+#include "TruckSim.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+// scenarios advanced together so their state stays in cache across steps
+const size_t BLOCK_SIZE = 256;
+
+// load "duration drive tilt" lines, '#' starts a comment
+bool TruckSimScript::load(const std::string& filename)
+{
+	std::ifstream file(filename, std::ios::in);	// open file
+
+	if (!file.is_open())
+	{
+		std::cerr << "Failed to open: " << filename << std::endl;
+		return false;
+	}
+
+	segments.clear();
+	std::string line;
+	while (std::getline(file, line))
+	{
+		// strip comments and skip blank lines
+		line = line.substr(0, line.find('#'));
+		std::stringstream stream(line);
+		TruckSimSegment segment;
+		if (!(stream >> segment.duration))
+			continue;
+
+		if (!(stream >> segment.drive >> segment.tilt) || segment.duration <= 0.0f)
+		{
+			std::cerr << "Invalid script line in " << filename << ": " << line << std::endl;
+			return false;
+		}
+
+		// clamp inputs to what the keyboard can produce
+		segment.drive = std::min(std::max(segment.drive, -1.0f), 1.0f);
+		segment.tilt = std::min(std::max(segment.tilt, -1.0f), 1.0f);
+		segments.push_back(segment);
+	}
+
+	return true;
+}
+
+// add a script, returns the index scenarios refer to it by
+int TruckSimBatch::addScript(const TruckSimScript& script)
+{
+	mScripts.push_back(script);
+	return static_cast<int>(mScripts.size()) - 1;
+}
+
+// add a scenario, returns its index
+size_t TruckSimBatch::addScenario(const TruckSimParams& params, int script,
+								  float truckPos, float groundSlope)
+{
+	mTruckPos.push_back(truckPos);
+	mGroundSlope.push_back(groundSlope);
+	mWheelAngle.push_back(0.0f);
+
+	mTranslateSensitivity.push_back(params.translateSensitivity);
+	mRotateSensitivity.push_back(params.rotateSensitivity);
+	mWheelRotateSensitivity.push_back(params.wheelRotateSensitivity);
+
+	mScript.push_back(script);
+	mSegment.push_back(0);
+	mSegmentTime.push_back(0.0f);
+
+	return mTruckPos.size() - 1;
+}
+
+// advance all scenarios - recordEvery = 0 keeps no trajectories
+void TruckSimBatch::run(int steps, float deltaTime, unsigned int threads, int recordEvery)
+{
+	mDeltaTime = deltaTime;
+	mRecordEvery = recordEvery;
+	mRecords = recordEvery > 0 ? steps / recordEvery + 1 : 0;	// initial state + every recordEvery steps
+	mTrajectory.assign(size() * mRecords * 3, 0.0f);
+
+	// split whole blocks between threads so no two threads share a block
+	size_t blocks = (size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	threads = static_cast<unsigned int>(std::max<size_t>(1, std::min<size_t>(threads, blocks)));
+
+	std::vector<std::thread> workers;
+	for (unsigned int t = 0; t < threads; t++)
+	{
+		size_t begin = std::min(size(), blocks * t / threads * BLOCK_SIZE),
+			   end = std::min(size(), blocks * (t + 1) / threads * BLOCK_SIZE);
+		workers.emplace_back(&TruckSimBatch::runRange, this, begin, end, steps, deltaTime);
+	}
+
+	for (std::thread& worker : workers)
+		worker.join();
+}
+
+// advance scenarios [begin, end)
+void TruckSimBatch::runRange(size_t begin, size_t end, int steps, float deltaTime)
+{
+	float drive[BLOCK_SIZE], tilt[BLOCK_SIZE];	// control inputs of the block for one step
+	float translateSensitivity[BLOCK_SIZE],		// sensitivities of the block
+		  rotateSensitivity[BLOCK_SIZE],
+		  wheelRotateSensitivity[BLOCK_SIZE];
+
+	for (size_t blockBegin = begin; blockBegin < end; blockBegin += BLOCK_SIZE)
+	{
+		size_t count = std::min(BLOCK_SIZE, end - blockBegin);
+		float* truckPos = &mTruckPos[blockBegin];
+		float* groundSlope = &mGroundSlope[blockBegin];
+		float* wheelAngle = &mWheelAngle[blockBegin];
+
+		// local copy of the sensitivities - the step loop then only writes arrays that
+		// cannot overlap what it reads, so it needs few runtime alias checks and vectorizes
+		for (size_t i = 0; i < count; i++)
+		{
+			translateSensitivity[i] = mTranslateSensitivity[blockBegin + i];
+			rotateSensitivity[i] = mRotateSensitivity[blockBegin + i];
+			wheelRotateSensitivity[i] = mWheelRotateSensitivity[blockBegin + i];
+		}
+
+		for (int step = 0; step <= steps; step++)
+		{
+			// record state before the step
+			if (mRecordEvery > 0 && step % mRecordEvery == 0)
+			{
+				size_t record = step / mRecordEvery;
+				for (size_t i = 0; i < count; i++)
+				{
+					float* sample = &mTrajectory[((blockBegin + i) * mRecords + record) * 3];
+					sample[0] = truckPos[i];
+					sample[1] = groundSlope[i];
+					sample[2] = wheelAngle[i];
+				}
+			}
+
+			if (step == steps)
+				break;
+
+			// play back scripts
+			for (size_t i = 0; i < count; i++)
+			{
+				size_t s = blockBegin + i;
+				const std::vector<TruckSimSegment>& segments = mScripts[mScript[s]].segments;
+				if (segments.empty())
+				{
+					drive[i] = tilt[i] = 0.0f;
+					continue;
+				}
+
+				const TruckSimSegment& segment = segments[mSegment[s]];
+				drive[i] = segment.drive;
+				tilt[i] = segment.tilt;
+
+				// move on to the next segment once this one has run its duration
+				mSegmentTime[s] += deltaTime;
+				if (mSegmentTime[s] >= segment.duration)
+				{
+					mSegmentTime[s] -= segment.duration;
+					mSegment[s] = (mSegment[s] + 1) % static_cast<int>(segments.size());
+				}
+			}
+
+			// advance the block - truck_sim_step is branch-free so this loop vectorizes
+			for (size_t i = 0; i < count; i++)
+			{
+				TruckSimParams params;
+				params.translateSensitivity = translateSensitivity[i];
+				params.rotateSensitivity = rotateSensitivity[i];
+				params.wheelRotateSensitivity = wheelRotateSensitivity[i];
+				truck_sim_step(truckPos[i], groundSlope[i], wheelAngle[i], params, drive[i], tilt[i], deltaTime);
+			}
+		}
+	}
+}
+
+// write the recorded trajectories as "scenario,time,position,slope,wheel_angle" rows
+bool TruckSimBatch::writeCSV(const std::string& filename) const
+{
+	std::ofstream file(filename, std::ios::out);	// open file
+
+	if (!file.is_open())
+	{
+		std::cerr << "Failed to open: " << filename << std::endl;
+		return false;
+	}
+
+	file << "scenario,time,position,slope,wheel_angle\n";
+	for (size_t s = 0; s < size(); s++)
+	{
+		for (int r = 0; r < mRecords; r++)
+		{
+			const float* sample = &mTrajectory[(s * mRecords + r) * 3];
+			file << s << ',' << r * mRecordEvery * mDeltaTime << ','
+				 << sample[0] << ',' << sample[1] << ',' << sample[2] << '\n';
+		}
+	}
+
+	return file.good();
+}
+
+// write the recorded trajectories as a header followed by raw floats:
+// "TSIM", uint32 version, uint32 scenarios, uint32 records, float record interval,
+// then [scenario][record][position, slope, wheel angle] little-endian floats
+bool TruckSimBatch::writeBinary(const std::string& filename) const
+{
+	std::ofstream file(filename, std::ios::out | std::ios::binary);	// open file
+
+	if (!file.is_open())
+	{
+		std::cerr << "Failed to open: " << filename << std::endl;
+		return false;
+	}
+
+	uint32_t version = 1,
+			 scenarios = static_cast<uint32_t>(size()),
+			 records = static_cast<uint32_t>(mRecords);
+	float interval = mRecordEvery * mDeltaTime;
+
+	file.write("TSIM", 4);
+	file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+	file.write(reinterpret_cast<const char*>(&scenarios), sizeof(scenarios));
+	file.write(reinterpret_cast<const char*>(&records), sizeof(records));
+	file.write(reinterpret_cast<const char*>(&interval), sizeof(interval));
+	if (!mTrajectory.empty())
+		file.write(reinterpret_cast<const char*>(&mTrajectory[0]), sizeof(float) * mTrajectory.size());
+
+	return file.good();
+}
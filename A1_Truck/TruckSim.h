@@ -0,0 +1,101 @@
+#ifndef TRUCK_SIM_H
+#define TRUCK_SIM_H
+
+// truck-on-slope simulation - no OpenGL or GLFW dependency so it can run headless
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// slope of the ground is limited to +/- this many degrees
+const float TRUCK_SIM_MAX_SLOPE = 15.0f;
+const float TRUCK_SIM_RAD_TO_DEG = 57.2957795f;
+
+// per-scenario sensitivities (defaults match the interactive scene)
+struct TruckSimParams
+{
+	float translateSensitivity = 0.1f;		// truck speed at full drive
+	float rotateSensitivity = 0.1f;			// slope change (radians per second) at full tilt
+	float wheelRotateSensitivity = 1.0f;	// wheel spin (radians per second) at full drive
+};
+
+// advance one truck by one step
+// drive: -1 = left, 1 = right; tilt: -1 = lower slope, 1 = raise slope
+inline void truck_sim_step(float& truckPos, float& groundSlope, float& wheelAngle,
+						   const TruckSimParams& params, float drive, float tilt, float deltaTime)
+{
+	// move truck and roll the wheels with it
+	truckPos += drive * params.translateSensitivity * deltaTime;
+	wheelAngle -= drive * params.wheelRotateSensitivity * deltaTime;
+
+	// tilt ground, only while below the limit in the direction of the tilt
+	// (non-short-circuit & and | keep this free of branches so batch loops vectorize)
+	int up = (tilt > 0.0f) & (groundSlope < TRUCK_SIM_MAX_SLOPE);
+	int down = (tilt < 0.0f) & (groundSlope > -TRUCK_SIM_MAX_SLOPE);
+	groundSlope += static_cast<float>(up | down) * tilt * params.rotateSensitivity * deltaTime * TRUCK_SIM_RAD_TO_DEG;
+}
+
+// one piece of a control script - inputs held for a duration
+struct TruckSimSegment
+{
+	float duration;	// seconds
+	float drive;	// [-1, 1]
+	float tilt;		// [-1, 1]
+};
+
+// scripted control inputs - segments played in order and looped
+struct TruckSimScript
+{
+	std::vector<TruckSimSegment> segments;
+
+	// load "duration drive tilt" lines, '#' starts a comment
+	bool load(const std::string& filename);
+};
+
+// independent scenarios stored as structure of arrays and advanced in parallel
+class TruckSimBatch
+{
+public:
+	// add a script, returns the index scenarios refer to it by
+	int addScript(const TruckSimScript& script);
+	// add a scenario, returns its index
+	size_t addScenario(const TruckSimParams& params, int script,
+					   float truckPos = 0.0f, float groundSlope = 0.0f);
+
+	// advance all scenarios - recordEvery = 0 keeps no trajectories
+	void run(int steps, float deltaTime, unsigned int threads, int recordEvery);
+
+	// write the recorded trajectories, returns false if the file could not be written
+	bool writeCSV(const std::string& filename) const;
+	bool writeBinary(const std::string& filename) const;
+
+	size_t size() const { return mTruckPos.size(); }
+
+	// current state of every scenario
+	std::vector<float> mTruckPos,
+					   mGroundSlope,
+					   mWheelAngle;
+
+private:
+	// advance scenarios [begin, end)
+	void runRange(size_t begin, size_t end, int steps, float deltaTime);
+
+	// parameters
+	std::vector<float> mTranslateSensitivity,
+					   mRotateSensitivity,
+					   mWheelRotateSensitivity;
+
+	// script playback
+	std::vector<TruckSimScript> mScripts;
+	std::vector<int> mScript;			// script of each scenario
+	std::vector<int> mSegment;			// current segment of each scenario
+	std::vector<float> mSegmentTime;	// time spent in the current segment
+
+	// trajectories - [scenario][record][position, slope, wheel angle]
+	std::vector<float> mTrajectory;
+	int mRecordEvery = 0,	// steps between records
+		mRecords = 0;		// records per scenario
+	float mDeltaTime = 0.0f;
+};
+
+#endif
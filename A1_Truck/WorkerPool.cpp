@@ -0,0 +1,99 @@
+#include "WorkerPool.h"
+
+WorkerPool::WorkerPool() : mNext(0)
+{}
+
+WorkerPool::~WorkerPool()
+{
+	stop();
+}
+
+// start the workers - 0 uses one less than the number of cores (the caller also works)
+void WorkerPool::start(unsigned int threads)
+{
+	stop();
+
+	if (threads == 0)
+	{
+		unsigned int cores = std::thread::hardware_concurrency();
+		threads = cores > 1 ? cores - 1 : 0;
+	}
+
+	mQuit = false;
+	for (unsigned int i = 0; i < threads; i++)
+		mThreads.emplace_back(&WorkerPool::workerLoop, this);
+}
+
+// finish and join the workers
+void WorkerPool::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mQuit = true;
+	}
+	mWake.notify_all();
+
+	for (std::thread& thread : mThreads)
+		thread.join();
+	mThreads.clear();
+}
+
+// run task(i) for every i in [0, count) on the workers and the calling thread
+void WorkerPool::parallelFor(int count, const std::function<void(int)>& task)
+{
+	// no workers or nothing worth sharing
+	if (mThreads.empty() || count <= 1)
+	{
+		for (int i = 0; i < count; i++)
+			task(i);
+		return;
+	}
+
+	// publish the job
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mTask = &task;
+		mCount = count;
+		mNext = 0;
+		mPending = static_cast<int>(mThreads.size());
+		mGeneration++;
+	}
+	mWake.notify_all();
+
+	// take items alongside the workers
+	for (int i = mNext++; i < count; i = mNext++)
+		task(i);
+
+	// wait for the workers so the task can safely go out of scope
+	std::unique_lock<std::mutex> lock(mMutex);
+	mDone.wait(lock, [this] { return mPending == 0; });
+}
+
+void WorkerPool::workerLoop()
+{
+	unsigned int generation = 0;
+
+	while (true)
+	{
+		// wait for a new job
+		const std::function<void(int)>* task;
+		int count;
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			mWake.wait(lock, [this, generation] { return mQuit || mGeneration != generation; });
+			if (mQuit)
+				return;
+			generation = mGeneration;
+			task = mTask;
+			count = mCount;
+		}
+
+		for (int i = mNext++; i < count; i = mNext++)
+			(*task)(i);
+
+		// report back, the last worker wakes the caller
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (--mPending == 0)
+			mDone.notify_one();
+	}
+}
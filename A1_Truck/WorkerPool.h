@@ -0,0 +1,44 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// persistent worker threads for small per-frame jobs - avoids creating threads every frame
+class WorkerPool
+{
+public:
+	WorkerPool();
+	~WorkerPool();
+
+	// start the workers - 0 uses one less than the number of cores (the caller also works)
+	void start(unsigned int threads = 0);
+	// finish and join the workers
+	void stop();
+
+	// run task(i) for every i in [0, count) on the workers and the calling thread,
+	// returns once all have finished
+	void parallelFor(int count, const std::function<void(int)>& task);
+
+	unsigned int getThreadCount() const { return static_cast<unsigned int>(mThreads.size()) + 1; }
+
+private:
+	void workerLoop();
+
+	std::vector<std::thread> mThreads;
+	std::mutex mMutex;
+	std::condition_variable mWake,		// signals a new job or shutdown
+							mDone;		// signals all workers finished the job
+	const std::function<void(int)>* mTask = nullptr;
+	int mCount = 0;					// number of items in the job
+	std::atomic<int> mNext;			// next item to take
+	int mPending = 0;				// workers still busy with the job
+	unsigned int mGeneration = 0;	// incremented for every job
+	bool mQuit = false;
+};
+
+#endif
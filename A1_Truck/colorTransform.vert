@@ -4,8 +4,29 @@
 layout(location = 0) in vec3 aPosition;
 layout(location = 1) in vec3 aColor;
 
-// model space matrix
-uniform mat4 uModelMatrix;
+// maximum number of draw items (must match gMaxInstances)
+#define MAX_INSTANCES 16
+
+// camera of the view being drawn
+layout(std140) uniform CameraBlock
+{
+	mat4 uViewMatrix;
+	mat4 uProjectionMatrix;
+};
+
+// per draw item data, shared by every view
+struct Instance
+{
+	mat4 modelMatrix;	// model space matrix
+	vec4 depth;			// x = layer along z, larger values are nearer the camera
+};
+layout(std140) uniform InstanceBlock
+{
+	Instance uInstances[MAX_INSTANCES];
+};
+
+// draw item being drawn
+uniform int uInstance;
 
 // output data
 out vec3 vColor;
@@ -13,7 +34,9 @@ out vec3 vColor;
 void main()
 {
 	// set vertex position
-    gl_Position = uModelMatrix * vec4(aPosition, 1.0f);
+	Instance instance = uInstances[uInstance];
+    gl_Position = uProjectionMatrix * uViewMatrix * instance.modelMatrix
+		* vec4(aPosition.xy, aPosition.z + instance.depth.x, 1.0f);
 
 	// set vertex shader output color 
 	// will be interpolated for each fragment
@@ -0,0 +1,14 @@
+#version 330 core
+
+// interpolated values from the vertex shaders (unused - every fragment counts the same)
+in vec3 vColor;
+
+// output data
+out vec3 fColor;
+
+void main()
+{
+	// added to the framebuffer for every fragment that passes the depth test,
+	// so brightness shows how many times each pixel was shaded (white = 10 or more)
+	fColor = vec3(0.1f);
+}
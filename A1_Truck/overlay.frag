@@ -0,0 +1,17 @@
+#version 330 core
+
+// interpolated values from the vertex shaders
+in vec2 vTexCoord;
+in vec4 vColor;
+
+// font atlas - coverage in the red channel
+uniform sampler2D uFontAtlas;
+
+// output data
+out vec4 fColor;
+
+void main()
+{
+	// set output color
+	fColor = vec4(vColor.rgb, vColor.a * texture(uFontAtlas, vTexCoord).r);
+}
@@ -0,0 +1,23 @@
+#version 330 core
+
+// input data
+layout(location = 0) in vec2 aPosition;	// pixels from the top left of the window
+layout(location = 1) in vec2 aTexCoord;
+layout(location = 2) in vec4 aColor;
+
+// window size in pixels
+uniform vec2 uScreenSize;
+
+// output data
+out vec2 vTexCoord;
+out vec4 vColor;
+
+void main()
+{
+	// pixel coordinates to clip space, y pointing down
+	gl_Position = vec4(aPosition.x / uScreenSize.x * 2.0f - 1.0f,
+					   1.0f - aPosition.y / uScreenSize.y * 2.0f, 0.0f, 1.0f);
+
+	vTexCoord = aTexCoord;
+	vColor = aColor;
+}
@@ -0,0 +1,18 @@
+#version 330 core
+
+// interpolated values from the vertex shaders
+in vec4 vColor;
+
+// output data
+out vec4 fColor;
+
+void main()
+{
+	// round, soft-edged points
+	float distance = length(gl_PointCoord - vec2(0.5f)) * 2.0f;
+	if (distance > 1.0f)
+		discard;
+
+	// set output color
+	fColor = vec4(vColor.rgb, vColor.a * (1.0f - distance * distance));
+}
@@ -0,0 +1,48 @@
+#version 330 core
+
+// input data
+layout(location = 0) in vec3 aPosition;
+layout(location = 2) in vec3 aState;	// age, life, type
+
+// camera of the view being drawn
+layout(std140) uniform CameraBlock
+{
+	mat4 uViewMatrix;
+	mat4 uProjectionMatrix;
+};
+// scales point sizes with the render resolution and zoom
+uniform float uPointScale;
+
+// particles are layered in front of every opaque object
+const float cDepth = 0.5f;
+
+// output data
+out vec4 vColor;
+
+void main()
+{
+	float age = aState.x;
+	float life = aState.y;
+
+	// dead particles are moved outside the clip volume
+	if (age >= life) {
+		gl_Position = vec4(2.0f, 2.0f, 2.0f, 1.0f);
+		gl_PointSize = 1.0f;
+		vColor = vec4(0.0f);
+		return;
+	}
+
+	// set vertex position
+	gl_Position = uProjectionMatrix * uViewMatrix * vec4(aPosition.xy, cDepth, 1.0f);
+
+	// exhaust grows and fades to transparent, dust shrinks slightly
+	// (largest size must match PARTICLE_MAX_POINT_SIZE)
+	float t = age / life;
+	if (aState.z < 0.5f) {
+		gl_PointSize = mix(3.0f, 10.0f, t) * uPointScale;
+		vColor = vec4(mix(vec3(0.25f), vec3(0.6f), t), 0.5f * (1.0f - t));
+	} else {
+		gl_PointSize = mix(3.0f, 2.0f, t) * uPointScale;
+		vColor = vec4(0.55f, 0.45f, 0.3f, 0.8f * (1.0f - t));
+	}
+}
@@ -0,0 +1,103 @@
+#version 330 core
+
+// maximum number of emitters (must match MAX_PARTICLE_EMITTERS)
+#define MAX_EMITTERS 4
+
+// input data - particle state from the previous frame
+layout(location = 0) in vec3 aPosition;
+layout(location = 1) in vec3 aVelocity;
+layout(location = 2) in vec3 aState;	// age, life, type
+
+// emitters
+uniform int uNumEmitters;
+uniform vec3 uEmitterPosition[MAX_EMITTERS];
+uniform vec3 uEmitterDirection[MAX_EMITTERS];
+uniform float uEmitterSpread[MAX_EMITTERS];
+uniform int uEmitterCount[MAX_EMITTERS];	// particles spawned this frame
+uniform float uEmitterLife[MAX_EMITTERS];
+uniform float uEmitterType[MAX_EMITTERS];
+
+// simulation step
+uniform float uDeltaTime;
+uniform int uFrame;
+uniform int uMaxParticles;
+uniform int uSpawnFirst;	// first slot spawned into this frame, the emitters take the next slots in order
+
+// output data - captured with transform feedback
+out vec3 tfPosition;
+out vec3 tfVelocity;
+out vec3 tfState;
+
+// exhaust drifts upwards and slows down, dust falls back to the ground
+// (ParticleSystem.cpp bounds particles with the same values)
+const vec3 cExhaustAcceleration = vec3(0.0f, 0.08f, 0.0f);
+const vec3 cDustAcceleration = vec3(0.0f, -0.6f, 0.0f);
+const float cExhaustDrag = 0.8f;
+
+// integer hash used to generate random numbers
+uint hash(uint x)
+{
+	x ^= x >> 16;
+	x *= 0x7feb352dU;
+	x ^= x >> 15;
+	x *= 0x846ca68bU;
+	x ^= x >> 16;
+	return x;
+}
+
+// random number in [0, 1) - advances the seed
+float random(inout uint seed)
+{
+	seed = hash(seed);
+	return float(seed >> 8) / 16777216.0f;
+}
+
+void main()
+{
+	uint seed = hash(uint(gl_VertexID) ^ hash(uint(uFrame)));
+	float age = aState.x + uDeltaTime;
+	float life = aState.y;
+	float type = aState.z;
+
+	// slots handed out this frame are respawned, taken by the emitters in order
+	int slot = (gl_VertexID - uSpawnFirst + uMaxParticles) % uMaxParticles;
+	int emitter = -1;
+	for (int i = 0; i < uNumEmitters; i++) {
+		if (slot < uEmitterCount[i]) {
+			emitter = i;
+			break;
+		}
+		slot -= uEmitterCount[i];
+	}
+
+	// not spawning and alive - integrate motion
+	if (emitter < 0 && age < life) {
+		vec3 velocity = aVelocity;
+		if (type < 0.5f) {
+			velocity += cExhaustAcceleration * uDeltaTime;
+			velocity *= max(1.0f - cExhaustDrag * uDeltaTime, 0.0f);
+		} else {
+			velocity += cDustAcceleration * uDeltaTime;
+		}
+
+		tfPosition = aPosition + velocity * uDeltaTime;
+		tfVelocity = velocity;
+		tfState = vec3(age, life, type);
+		return;
+	}
+
+	// not spawning and dead - stay dead
+	if (emitter < 0) {
+		tfPosition = aPosition;
+		tfVelocity = vec3(0.0f);
+		tfState = vec3(0.0f, 0.0f, type);
+		return;
+	}
+
+	// random offset around the emitter direction
+	vec3 jitter = vec3(random(seed) - 0.5f, random(seed) - 0.5f, 0.0f) * 2.0f;
+
+	tfPosition = uEmitterPosition[emitter] + jitter * 0.01f;
+	tfVelocity = uEmitterDirection[emitter] + jitter * uEmitterSpread[emitter];
+	tfState = vec3(0.0f, uEmitterLife[emitter] * (0.5f + 0.5f * random(seed)), uEmitterType[emitter]);
+}
@@ -0,0 +1,196 @@
+// headless batch runner for the truck-on-slope simulation - no window or OpenGL context needed
+//
+// usage: TruckSimBatch [options]
+//   --scenarios N           number of independent scenarios (default 10000)
+//   --steps N               steps per scenario (default 1000)
+//   --dt SECONDS            time step (default 1/60)
+//   --threads N             worker threads (default all cores)
+//   --script FILE           control script, may be repeated (default random scripts)
+//   --seed N                seed for random scripts and start states (default 1)
+//   --sweep-translate A B   sweep truck speed sensitivity from A to B across scenarios
+//   --sweep-rotate A B      sweep slope sensitivity from A to B across scenarios
+//   --record-every N        steps between trajectory samples (default 10)
+//   --out FILE              write trajectories, .csv for text, anything else binary
+//   --bench                 report scenario-steps per second for 1 thread up to --threads
+
+// C++ related headers
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace std;
+
+#include "../A1_Truck/TruckSim.h"
+
+// command line settings
+struct Settings {
+	int scenarios = 10000,
+		steps = 1000,
+		recordEvery = 10,
+		seed = 1;
+	unsigned int threads = 0;
+	float deltaTime = 1.0f / 60.0f;
+	float translateRange[2] = { 0.1f, 0.1f },
+		  rotateRange[2] = { 0.1f, 0.1f };
+	vector<string> scripts;
+	string out;
+	bool bench = false;
+};
+
+// output usage and exit
+static void usage(const char* program) {
+	cerr << "usage: " << program << " [--scenarios N] [--steps N] [--dt SECONDS] [--threads N]\n"
+		 << "       [--script FILE]... [--seed N] [--sweep-translate A B] [--sweep-rotate A B]\n"
+		 << "       [--record-every N] [--out FILE] [--bench]" << endl;
+	exit(EXIT_FAILURE);
+}
+
+// parse command line arguments
+static Settings parse_arguments(int argc, char** argv) {
+	Settings settings;
+
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		// number of values following the option
+		int values = (arg == "--bench") ? 0
+				   : (arg == "--sweep-translate" || arg == "--sweep-rotate") ? 2 : 1;
+		if (i + values >= argc)
+			usage(argv[0]);
+
+		if (arg == "--scenarios")				settings.scenarios = atoi(argv[++i]);
+		else if (arg == "--steps")				settings.steps = atoi(argv[++i]);
+		else if (arg == "--dt")					settings.deltaTime = static_cast<float>(atof(argv[++i]));
+		else if (arg == "--threads")			settings.threads = static_cast<unsigned int>(atoi(argv[++i]));
+		else if (arg == "--script")				settings.scripts.push_back(argv[++i]);
+		else if (arg == "--seed")				settings.seed = atoi(argv[++i]);
+		else if (arg == "--record-every")		settings.recordEvery = atoi(argv[++i]);
+		else if (arg == "--out")				settings.out = argv[++i];
+		else if (arg == "--bench")				settings.bench = true;
+		else if (arg == "--sweep-translate") {
+			settings.translateRange[0] = static_cast<float>(atof(argv[++i]));
+			settings.translateRange[1] = static_cast<float>(atof(argv[++i]));
+		}
+		else if (arg == "--sweep-rotate") {
+			settings.rotateRange[0] = static_cast<float>(atof(argv[++i]));
+			settings.rotateRange[1] = static_cast<float>(atof(argv[++i]));
+		}
+		else
+			usage(argv[0]);
+	}
+
+	if (settings.scenarios <= 0 || settings.steps <= 0 || settings.deltaTime <= 0.0f || settings.recordEvery < 0)
+		usage(argv[0]);
+
+	// a trajectory file needs at least one sample per scenario
+	if (!settings.out.empty() && settings.recordEvery == 0) {
+		cerr << "--out needs --record-every greater than 0" << endl;
+		exit(EXIT_FAILURE);
+	}
+
+	// default to all cores
+	if (settings.threads == 0)
+		settings.threads = max(1u, thread::hardware_concurrency());
+
+	return settings;
+}
+
+// random script - drive and tilt held for 0.5 to 3 seconds at a time
+static TruckSimScript random_script(mt19937& random) {
+	uniform_real_distribution<float> duration(0.5f, 3.0f);
+	uniform_int_distribution<int> input(-1, 1);
+
+	TruckSimScript script;
+	for (int i = 0; i < 8; i++)
+		script.segments.push_back({ duration(random),
+									static_cast<float>(input(random)),
+									static_cast<float>(input(random)) });
+	return script;
+}
+
+// build the batch - scenarios cycle through the scripts and sweep the parameter ranges
+static void build_batch(const Settings& settings, TruckSimBatch& batch) {
+	mt19937 random(settings.seed);
+	int scripts = 0;
+
+	for (const string& filename : settings.scripts) {
+		TruckSimScript script;
+		if (!script.load(filename))
+			exit(EXIT_FAILURE);
+		batch.addScript(script);
+		scripts++;
+	}
+
+	// no scripts given - one random script per 16 scenarios
+	if (scripts == 0) {
+		for (; scripts < (settings.scenarios + 15) / 16; scripts++)
+			batch.addScript(random_script(random));
+	}
+
+	uniform_real_distribution<float> startPos(-0.5f, 0.5f),
+									 startSlope(-TRUCK_SIM_MAX_SLOPE, TRUCK_SIM_MAX_SLOPE);
+
+	for (int s = 0; s < settings.scenarios; s++) {
+		// position along the sweep in [0, 1]
+		float t = settings.scenarios > 1 ? static_cast<float>(s) / (settings.scenarios - 1) : 0.0f;
+
+		TruckSimParams params;
+		params.translateSensitivity = settings.translateRange[0]
+			+ t * (settings.translateRange[1] - settings.translateRange[0]);
+		params.rotateSensitivity = settings.rotateRange[0]
+			+ t * (settings.rotateRange[1] - settings.rotateRange[0]);
+
+		batch.addScenario(params, s % scripts, startPos(random), startSlope(random));
+	}
+}
+
+// time one run and report throughput
+static void benchmark(const Settings& settings, unsigned int threads) {
+	TruckSimBatch batch;
+	build_batch(settings, batch);
+
+	auto start = chrono::steady_clock::now();
+	batch.run(settings.steps, settings.deltaTime, threads, 0);
+	double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	double scenarioSteps = static_cast<double>(settings.scenarios) * settings.steps;
+	cout << threads << " thread(s): " << settings.scenarios << " scenarios x " << settings.steps
+		 << " steps in " << seconds << " s, " << scenarioSteps / seconds << " scenario-steps/s" << endl;
+}
+
+int main(int argc, char** argv) {
+	Settings settings = parse_arguments(argc, argv);
+
+	// throughput only - doubling threads up to the requested count
+	if (settings.bench) {
+		for (unsigned int threads = 1; threads < settings.threads; threads *= 2)
+			benchmark(settings, threads);
+		benchmark(settings, settings.threads);
+		exit(EXIT_SUCCESS);
+	}
+
+	TruckSimBatch batch;
+	build_batch(settings, batch);
+	batch.run(settings.steps, settings.deltaTime, settings.threads,
+			  settings.out.empty() ? 0 : settings.recordEvery);
+
+	// write trajectories - format chosen by file extension
+	if (!settings.out.empty()) {
+		bool csv = settings.out.size() >= 4 && settings.out.compare(settings.out.size() - 4, 4, ".csv") == 0;
+		if (!(csv ? batch.writeCSV(settings.out) : batch.writeBinary(settings.out)))
+			exit(EXIT_FAILURE);
+	}
+
+	// summary of the final states
+	float minPos = batch.mTruckPos[0], maxPos = batch.mTruckPos[0];
+	for (float pos : batch.mTruckPos) {
+		minPos = min(minPos, pos);
+		maxPos = max(maxPos, pos);
+	}
+	cout << settings.scenarios << " scenarios x " << settings.steps << " steps, final position range ["
+		 << minPos << ", " << maxPos << "]" << endl;
+
+	exit(EXIT_SUCCESS);
+}